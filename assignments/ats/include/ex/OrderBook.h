@@ -1,15 +1,18 @@
 #include <unordered_map>
 #include <unordered_set>
-#include <set>
 #include <vector>
 #include <algorithm>
 #include <iomanip>
+#include <chrono>
 
 #include "ex/msg/NewOrder.h"
 #include "ex/msg/AmendOrder.h"
 #include "ex/msg/CancelOrder.h"
 #include "ex/msg/Trade.h"
 #include "ex/state/OrderInfo.h"
+#include "ex/state/BookSide.h"
+#include "ex/state/TradeStats.h"
+#include "ex/mem/CountingAllocator.h"
 
 namespace ex {
     struct OrderBook {
@@ -17,101 +20,149 @@ namespace ex {
         ex::type::ErrorCode notify(const ex::msg::AmendOrder& obj);
         ex::type::ErrorCode notify(const ex::msg::CancelOrder& obj);
         ex::type::ErrorCode notify(const ex::msg::Trade& obj);
-        
+
+        // Bulk-loads a batch of NewOrders, e.g. the leading NewOrders of an
+        //  exchange snapshot. Result is the same as calling notify for each
+        //  order in turn; the returned error codes are in batch order.
+        //  Orders are grouped per product and side, the groups are sorted in
+        //  parallel by up to 'threads' workers (0 => hardware concurrency)
+        //  and empty sides are then built in a single pass.
+        std::vector<ex::type::ErrorCode> load(const std::vector<ex::msg::NewOrder>& orders, unsigned threads = 0);
+
         void print(std::ostream& out, std::size_t level, bool printHeader);
+        void print(std::ostream& out, ex::type::ProductId product, std::size_t level, bool printHeader);
         std::pair<ex::type::Price, ex::type::Quantity> getLastTradedPriceAndQuantiity(ex::type::ProductId productId) {
             return lastTradedPriceAndQuantity[productId];
         }
-    private:
-        using Buys = std::unordered_map<ex::type::ProductId, std::multiset<ex::state::OrderInfo, ex::state::DescendingPriceOrdering>>;
-        using Sells = std::unordered_map<ex::type::ProductId, std::multiset<ex::state::OrderInfo, ex::state::AscendingPriceOrdering>>;
-        using OrderIdToProductIdMap = std::unordered_map< ex::type::OrderId, ex::type::ProductId>;
-
-        Buys buys;
-        Sells sells;
-        OrderIdToProductIdMap orderIdToProductIdMap;
-        std::unordered_set<ex::type::ProductId> products;
-        std::unordered_map<ex::type::ProductId, std::pair<ex::type::Price, ex::type::Quantity>> lastTradedPriceAndQuantity;
 
-        bool orderExists(ex::type::OrderId orderId) const {
-            return orderIdToProductIdMap.find( orderId ) != orderIdToProductIdMap.end();
+        // Rolling VWAP, volume and OHLC bars of the trades seen for productId
+        const ex::state::TradeStats& getTradeStats(ex::type::ProductId productId) {
+            return tradeStatsFor(productId);
         }
-        template<typename OrderSet>
-        ex::type::ErrorCode amend(OrderSet& infoSet, const ex::msg::AmendOrder& obj) {
-           auto orderId = obj.orderId;
-           auto iter = std::find_if( infoSet.begin(), infoSet.end(), [orderId](const ex::state::OrderInfo& info) {
-               return info.orderId == orderId;
-           });
-
-           if( iter == infoSet.end() ) return ex::type::ErrorCode::InvalidOrderId;
-
-           infoSet.erase( iter );
-           ex::state::OrderInfo newInfo;
-           newInfo.orderId = obj.orderId;
-           newInfo.price = obj.price;
-           newInfo.quantity = obj.quantity;
- 
-           infoSet.emplace( newInfo );
 
-           return ex::type::ErrorCode::Ok;
+        // Applies to products whose first trade arrives after this call.
+        //  Returns false, keeping the current config, if config is not valid
+        bool setTradeStatsConfig(const ex::state::TradeStats::Config& config) {
+            if( !config.isValid() ) return false;
+            tradeStatsConfig = config;
+            return true;
         }
 
-        template<typename OrderSet>
-        ex::type::ErrorCode cancel(OrderSet& infoSet, const ex::msg::CancelOrder& obj) {
-           ex::type::ErrorCode err = ex::type::ErrorCode::Ok;
+        // Feed time given to the trade statistics with every trade from now
+        //  on, which time bars are closed on. The caller advances it as it
+        //  reads the timestamps of its feed; the sample feeds have none and
+        //  use count bars.
+        void setFeedTime(std::chrono::nanoseconds at) { feedTime = at; }
+
+        struct ProductFootprint {
+            std::size_t bidOrders = 0;
+            std::size_t askOrders = 0;
+            std::size_t bidLevels = 0;
+            std::size_t askLevels = 0;
+            std::size_t zeroQuantityOrders = 0;
+        };
+
+        // Number of orders and levels resting in the book of productId
+        // TimeComplexity: O(1) - Amortized Cost
+        ProductFootprint getFootprint(ex::type::ProductId productId) const;
+
+        // Prints the footprint of every product followed by the heap usage
+        //  of every subsystem
+        void printFootprint(std::ostream& out) const;
+    private:
+        using Buys = ex::state::BookSide<ex::state::DescendingPriceOrdering>;
+        using Sells = ex::state::BookSide<ex::state::AscendingPriceOrdering>;
+
+        struct ProductBook {
+            Buys buys;
+            Sells sells;
+        };
+
+        // Cancelled orders keep their entry (with an invalid location) so
+        //  that their ids cannot be reused, as with the exchange
+        struct OrderEntry {
+            ex::type::ProductId productId;
+            ex::type::Side side;
+            ex::state::OrderLocation location;
+        };
+        using OrderIndex = ex::mem::UnorderedMap<ex::type::OrderId, OrderEntry, ex::mem::Subsystem::OrderIndex>;
+
+        template<typename V>
+        using ProductMap = ex::mem::UnorderedMap<ex::type::ProductId, V, ex::mem::Subsystem::ProductMaps>;
+
+        ProductMap<ProductBook> books;
+        OrderIndex orderIndex;
+        ex::mem::UnorderedSet<ex::type::ProductId, ex::mem::Subsystem::ProductMaps> products;
+        ProductMap<std::pair<ex::type::Price, ex::type::Quantity>> lastTradedPriceAndQuantity;
+        ProductMap<ex::state::TradeStats> tradeStats;
+        ex::state::TradeStats::Config tradeStatsConfig;
+        std::chrono::nanoseconds feedTime = std::chrono::nanoseconds::zero();
+        std::uint64_t entrySeq = 0;
+
+        ex::state::TradeStats& tradeStatsFor(ex::type::ProductId productId) {
+            auto iter = tradeStats.find( productId );
+            if( iter == tradeStats.end() ) {
+                iter = tradeStats.emplace( productId, ex::state::TradeStats( tradeStatsConfig ) ).first;
+            }
+            return iter->second;
+        }
 
-           auto orderId = obj.orderId;
-           auto iter = std::find_if( infoSet.begin(), infoSet.end(), [orderId](const ex::state::OrderInfo& info) {
-               return info.orderId == orderId;
-           });
+        void printProduct(std::ostream& out, ex::type::ProductId product, std::size_t level);
 
-           if( iter != infoSet.end() ) {
-               infoSet.erase( iter );
-           } else {
-              err = ex::type::ErrorCode::InvalidOrderId; 
-           }
+        bool orderExists(ex::type::OrderId orderId) const {
+            return orderIndex.find( orderId ) != orderIndex.end();
+        }
 
-            return err;
+        // An order in the bulk-load batch along with the index entry its
+        //  location has to be written to
+        struct BatchEntry {
+            ex::state::OrderInfo info;
+            std::uint64_t seq;
+            OrderEntry* entry;
+        };
+
+        template<typename BookSide>
+        static void bulkInsert(BookSide& side, std::vector<BatchEntry>& batch) {
+            // stable_sort keeps the arrival order within a price, which is
+            //  the queue order incremental processing would have produced
+            std::stable_sort( batch.begin(), batch.end(), [](const BatchEntry& lhs, const BatchEntry& rhs) {
+                return BookSide::worse( lhs.info.price, rhs.info.price );
+            });
+            auto onAdded = [](const BatchEntry& e, const ex::state::OrderLocation& loc) { e.entry->location = loc; };
+            if( side.empty() ) {
+                side.build( batch, onAdded );
+            } else {
+                for(auto& e: batch ) onAdded( e, side.add( e.info.orderId, e.info.quantity, e.info.price, e.seq ) );
+            }
         }
 
-        template<typename Iter> 
-        Iter bestPriceMatch(Iter b, Iter e, ex::type::Price price) {
-            return std::find_if( b, e, [price](const ex::state::OrderInfo& info) { return info.price == price; }); 
+        // Moves the order to the back of the queue at the amended price
+        template<typename BookSide>
+        ex::type::ErrorCode amend(BookSide& side, OrderEntry& entry, const ex::msg::AmendOrder& obj) {
+           side.remove( entry.location );
+           entry.location = side.add( obj.orderId, obj.quantity, obj.price, ++entrySeq );
+           return ex::type::ErrorCode::Ok;
         }
- 
-       template<typename OrderSet> 
-       bool execute(OrderSet& orderSet, const ex::msg::Trade& obj) {
-           ex::type::Quantity remainingQty = obj.quantity;
-           auto iter = bestPriceMatch( orderSet.begin(), orderSet.end(), obj.price );
-           if( iter == orderSet.end() ) return false; //TradeWithNoValid Order
-
-           while( remainingQty > 0 && iter != orderSet.end() ) {
-               if( iter->quantity >= remainingQty ) {
-                   ex::state::OrderInfo newInfo = *iter;
-                   newInfo.quantity -= remainingQty;
-                   orderSet.erase( iter );
-                   iter = orderSet.emplace( newInfo ); 
-                   remainingQty = 0;
-               } else { // All quatity for this order can be executed. so quantity for this order needs to be set to 0
-                   remainingQty -= iter->quantity;
-
-                   ex::state::OrderInfo newInfo = *iter;
-                   newInfo.quantity = 0;
-
-                   orderSet.erase( iter );
-                   iter = orderSet.emplace( newInfo ); 
-               }
-               iter = bestPriceMatch( ++iter, orderSet.end(), obj.price ); //Try the next bestMatch
-           }
 
-            return true;
+        template<typename BookSide>
+        ex::type::ErrorCode cancel(BookSide& side, OrderEntry& entry) {
+           side.remove( entry.location );
+           entry.location = ex::state::OrderLocation();
+           return ex::type::ErrorCode::Ok;
         }
 
-       template<typename BuyOrderSet, typename SellOrderSet> 
-        ex::type::ErrorCode execute(BuyOrderSet& buySet, SellOrderSet& sellSet, const ex::msg::Trade& obj) {
+        // Only the order at the front of the queue at the traded price takes
+        //  part in the trade, after which it moves to the back of the queue.
+        //  Fully executed orders stay in the book with zero quantity.
+        template<typename BuySide, typename SellSide>
+        ex::type::ErrorCode execute(BuySide& buySide, SellSide& sellSide, const ex::msg::Trade& obj) {
 
-           if( execute( buySet, obj) ) return ex::type::ErrorCode::TradeWithNoValidBuySide;
-           if( execute( sellSet, obj) ) return ex::type::ErrorCode::TradeWithNoValidSellSide;
+           // Both sides are checked before either is touched, so that a
+           //  rejected trade leaves the book as it was
+           if( !buySide.hasLevel( obj.price ) ) return ex::type::ErrorCode::TradeWithNoValidBuySide;
+           if( !sellSide.hasLevel( obj.price ) ) return ex::type::ErrorCode::TradeWithNoValidSellSide;
+           buySide.execute( obj.price, obj.quantity );
+           sellSide.execute( obj.price, obj.quantity );
 
            auto& priceQtyPair = lastTradedPriceAndQuantity[obj.productId];
            if( priceQtyPair.first == obj.price ) { //Update Quantity
@@ -120,6 +171,7 @@ namespace ex {
                priceQtyPair.first = obj.price;
                priceQtyPair.second = obj.quantity;
            }
+           tradeStatsFor( obj.productId ).notify( obj.price, obj.quantity, feedTime );
 
             return ex::type::ErrorCode::Ok;
        }
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ex{ namespace mem{
+
+    // Parts of the feed handler whose heap usage is tracked separately
+    enum class Subsystem : std::size_t {
+        BookNodes       // price levels and the order blocks they own
+        , OrderIndex    // order id => location of the order
+        , ProductMaps   // per product books, last trades and trade statistics
+        , ErrorStorage  // rejected messages kept for reporting
+        , Count
+    };
+
+    std::ostream& operator<<(std::ostream& out, Subsystem s);
+
+    // Counters are updated with relaxed atomics, as bulk loads allocate
+    //  from several threads at once
+    struct AllocationStats {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> deallocations{0};
+        std::atomic<std::uint64_t> currentBytes{0};
+        std::atomic<std::uint64_t> peakBytes{0};
+
+        void onAllocate(std::size_t bytes) {
+            allocations.fetch_add( 1, std::memory_order_relaxed );
+            auto current = currentBytes.fetch_add( bytes, std::memory_order_relaxed ) + bytes;
+            auto peak = peakBytes.load( std::memory_order_relaxed );
+            while( current > peak && !peakBytes.compare_exchange_weak( peak, current, std::memory_order_relaxed ) ) {}
+        }
+
+        void onDeallocate(std::size_t bytes) {
+            deallocations.fetch_add( 1, std::memory_order_relaxed );
+            currentBytes.fetch_sub( bytes, std::memory_order_relaxed );
+        }
+    };
+
+    inline AllocationStats& statsOf(Subsystem s) {
+        static AllocationStats stats[ static_cast<std::size_t>(Subsystem::Count) ];
+        return stats[ static_cast<std::size_t>(s) ];
+    }
+
+    // Total number of allocations made by all subsystems so far
+    inline std::uint64_t totalAllocations() {
+        std::uint64_t total = 0;
+        for( std::size_t s = 0; s < static_cast<std::size_t>(Subsystem::Count); ++s ) {
+            total += statsOf( static_cast<Subsystem>(s) ).allocations.load( std::memory_order_relaxed );
+        }
+        return total;
+    }
+
+    // Bytes currently allocated by all subsystems
+    inline std::uint64_t totalCurrentBytes() {
+        std::uint64_t total = 0;
+        for( std::size_t s = 0; s < static_cast<std::size_t>(Subsystem::Count); ++s ) {
+            total += statsOf( static_cast<Subsystem>(s) ).currentBytes.load( std::memory_order_relaxed );
+        }
+        return total;
+    }
+
+    // Prints allocations, current and peak bytes per subsystem
+    void printAllocationStats(std::ostream& out);
+
+    // std::allocator replacement which accounts every allocation against
+    //  Subsystem S before handing it to the global operator new
+    template<typename T, Subsystem S>
+    struct CountingAllocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = CountingAllocator<U, S>;
+        };
+
+        CountingAllocator() = default;
+
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U, S>&) {}
+
+        T* allocate(std::size_t n) {
+            statsOf(S).onAllocate( n * sizeof(T) );
+            return static_cast<T*>( ::operator new( n * sizeof(T) ) );
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            statsOf(S).onDeallocate( n * sizeof(T) );
+            ::operator delete( p );
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U, S>&) const { return true; }
+
+        template<typename U>
+        bool operator!=(const CountingAllocator<U, S>&) const { return false; }
+    };
+
+    template<typename T, Subsystem S>
+    using Vector = std::vector<T, CountingAllocator<T, S>>;
+
+    template<typename K, typename V, Subsystem S>
+    using UnorderedMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, CountingAllocator<std::pair<const K, V>, S>>;
+
+    template<typename K, Subsystem S>
+    using UnorderedSet = std::unordered_set<K, std::hash<K>, std::equal_to<K>, CountingAllocator<K, S>>;
+}}
@@ -0,0 +1,235 @@
+#pragma once
+#include "ex/type/Types.h"
+#include "ex/state/OrderInfo.h"
+#include "ex/mem/CountingAllocator.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace ex{ namespace state{
+
+    using LevelId = std::uint32_t;
+    using Slot = std::uint32_t;
+    constexpr std::uint32_t NoIndex = ~std::uint32_t(0);
+
+    template<typename T>
+    using BookVector = ex::mem::Vector<T, ex::mem::Subsystem::BookNodes>;
+
+    // Where an order lives within a BookSide
+    struct OrderLocation {
+        OrderLocation() = default;
+        OrderLocation(LevelId l, Slot s) : level(l), slot(s) {}
+
+        LevelId level = NoIndex;
+        Slot slot = NoIndex;
+
+        bool isValid() const { return level != NoIndex; }
+    };
+
+    // All orders resting at a single price. The price is stored once for
+    //  the level and orders are kept in two arrays owned by the level,
+    //  indexed by the same slot: the fields walked while matching (quantity
+    //  and the FIFO links) share one 12 byte element, while the order id and
+    //  entry sequence, which are only needed for reporting, are kept in the
+    //  other. Slots of removed orders are chained into a free list and reused.
+    struct Level {
+        struct HotSlot {
+            ex::type::Quantity quantity;
+            Slot next;
+            Slot prev;
+        };
+
+        struct ColdSlot {
+            ex::type::OrderId orderId;
+            std::uint64_t entrySeq;
+        };
+
+        ex::type::Price price = 0.0;
+        Slot head = NoIndex;
+        Slot tail = NoIndex;
+        Slot freeSlot = NoIndex;
+        std::uint32_t count = 0;
+
+        BookVector<HotSlot> hot;
+        BookVector<ColdSlot> cold;
+
+        // Appends an order to the back of the FIFO queue
+        Slot append(ex::type::OrderId id, ex::type::Quantity qty, std::uint64_t seq) {
+            Slot slot = freeSlot;
+            if( slot != NoIndex ) {
+                freeSlot = hot[slot].next;
+                hot[slot].quantity = qty;
+                cold[slot] = ColdSlot{ id, seq };
+            } else {
+                slot = static_cast<Slot>( hot.size() );
+                hot.push_back( HotSlot{ qty, NoIndex, NoIndex } );
+                cold.push_back( ColdSlot{ id, seq } );
+            }
+            link( slot );
+            ++count;
+            return slot;
+        }
+
+        void remove(Slot slot) {
+            unlink( slot );
+            hot[slot].next = freeSlot;
+            freeSlot = slot;
+            --count;
+        }
+
+        // Moves an order to the back of the FIFO queue
+        void requeue(Slot slot) {
+            if( slot == tail ) return;
+            unlink( slot );
+            link( slot );
+        }
+
+        // Drops all orders but keeps the capacity for reuse
+        void clear() {
+            head = tail = freeSlot = NoIndex;
+            count = 0;
+            hot.clear();
+            cold.clear();
+        }
+    private:
+        void link(Slot slot) {
+            hot[slot].prev = tail;
+            hot[slot].next = NoIndex;
+            if( tail != NoIndex ) hot[tail].next = slot; else head = slot;
+            tail = slot;
+        }
+
+        void unlink(Slot slot) {
+            Slot p = hot[slot].prev;
+            Slot n = hot[slot].next;
+            if( p != NoIndex ) hot[p].next = n; else head = n;
+            if( n != NoIndex ) hot[n].prev = p; else tail = p;
+        }
+    };
+
+    // One side of the book of a single product. Levels are allocated from a
+    //  pool (so a LevelId stays valid while the level is alive) and are kept
+    //  sorted by price in a flat array, worst price first, so that levels
+    //  appearing or disappearing near the touch shift few entries.
+    //  BetterPrice(a, b) is true if price a is more aggressive than b.
+    template<typename BetterPrice>
+    struct BookSide {
+        // TimeComplexity: O(log L) for L levels, plus O(L) if a level is created
+        OrderLocation add(ex::type::OrderId id, ex::type::Quantity qty, ex::type::Price price, std::uint64_t seq) {
+            auto pos = findPosition( price );
+            LevelId level;
+            if( pos != prices.end() && *pos == price ) {
+                level = levelIds[ pos - prices.begin() ];
+            } else {
+                level = allocateLevel( price );
+                levelIds.insert( levelIds.begin() + ( pos - prices.begin() ), level );
+                prices.insert( pos, price );
+            }
+            ++orders;
+            if( qty == 0 ) ++zeroQuantityOrders;
+            return OrderLocation{ level, levels[level].append( id, qty, seq ) };
+        }
+
+        // TimeComplexity: Theta(1), plus O(L) if the level empties
+        void remove(const OrderLocation& loc) {
+            Level& level = levels[loc.level];
+            if( level.hot[loc.slot].quantity == 0 ) --zeroQuantityOrders;
+            level.remove( loc.slot );
+            --orders;
+            if( level.count == 0 ) releaseLevel( loc.level );
+        }
+
+        // True if an order rests at 'price'
+        // TimeComplexity: O(log L)
+        bool hasLevel(ex::type::Price price) const {
+            auto pos = std::lower_bound( prices.begin(), prices.end(), price, &BookSide::worse );
+            return pos != prices.end() && *pos == price;
+        }
+
+        // Applies a trade to the order at the front of the queue at 'price'
+        //  and moves that order to the back of the queue. Returns false if
+        //  there is no order at that price.
+        // TimeComplexity: O(log L)
+        bool execute(ex::type::Price price, ex::type::Quantity qty) {
+            auto pos = findPosition( price );
+            if( pos == prices.end() || *pos != price ) return false;
+
+            Level& level = levels[ levelIds[ pos - prices.begin() ] ];
+            Slot slot = level.head;
+            auto& orderQty = level.hot[slot].quantity;
+            if( orderQty != 0 && orderQty <= qty ) ++zeroQuantityOrders;
+            orderQty = orderQty >= qty ? orderQty - qty : 0;
+            level.requeue( slot );
+            return true;
+        }
+
+        // Appends a batch of orders in a single pass.
+        // Pre-Condition: side is empty and batch is sorted worst price first,
+        //  in arrival order within a price
+        // TimeComplexity: Theta(N)
+        template<typename Batch, typename OnAdded>
+        void build(const Batch& batch, OnAdded onAdded) {
+            for(auto& entry: batch ) {
+                const OrderInfo& info = entry.info;
+                if( prices.empty() || prices.back() != info.price ) {
+                    prices.push_back( info.price );
+                    levelIds.push_back( allocateLevel( info.price ) );
+                }
+                LevelId level = levelIds.back();
+                ++orders;
+                if( info.quantity == 0 ) ++zeroQuantityOrders;
+                onAdded( entry, OrderLocation{ level, levels[level].append( info.orderId, info.quantity, entry.seq ) } );
+            }
+        }
+
+        // Calls f(price) for every price level, best price first
+        template<typename F>
+        void forEachPrice(F f) const {
+            for( auto iter = prices.rbegin(); iter != prices.rend(); ++iter ) f( *iter );
+        }
+
+        std::size_t orderCount() const { return orders; } // TimeComplexity: Theta(1)
+        std::size_t levelCount() const { return prices.size(); } // TimeComplexity: Theta(1)
+        bool empty() const { return orders == 0; } // TimeComplexity: Theta(1)
+
+        // Fully executed orders stay in the book with zero quantity until
+        //  they are cancelled or amended
+        std::size_t zeroQuantityOrderCount() const { return zeroQuantityOrders; } // TimeComplexity: Theta(1)
+
+        // Sorts worst price first, as expected by build
+        static bool worse(ex::type::Price lhs, ex::type::Price rhs) { return BetterPrice()( rhs, lhs ); }
+    private:
+        BookVector<ex::type::Price> prices;
+        BookVector<LevelId> levelIds;
+        BookVector<Level> levels;
+        BookVector<LevelId> freeLevels;
+        std::size_t orders = 0;
+        std::size_t zeroQuantityOrders = 0;
+
+        BookVector<ex::type::Price>::iterator findPosition(ex::type::Price price) {
+            return std::lower_bound( prices.begin(), prices.end(), price, &BookSide::worse );
+        }
+
+        LevelId allocateLevel(ex::type::Price price) {
+            LevelId level;
+            if( !freeLevels.empty() ) {
+                level = freeLevels.back();
+                freeLevels.pop_back();
+            } else {
+                level = static_cast<LevelId>( levels.size() );
+                levels.emplace_back();
+            }
+            levels[level].price = price;
+            return level;
+        }
+
+        void releaseLevel(LevelId level) {
+            auto pos = findPosition( levels[level].price );
+            auto idx = pos - prices.begin();
+            prices.erase( pos );
+            levelIds.erase( levelIds.begin() + idx );
+            levels[level].clear();
+            freeLevels.push_back( level );
+        }
+    };
+}}
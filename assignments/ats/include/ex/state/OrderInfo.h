@@ -10,15 +10,21 @@ namespace ex{ namespace state{
     };
 
     struct DescendingPriceOrdering {
-        bool operator()(const ex::state::OrderInfo& lhs, const ex::state::OrderInfo& rhs) {
+        bool operator()(const ex::state::OrderInfo& lhs, const ex::state::OrderInfo& rhs) const {
             return lhs.price > rhs.price;
         }
+        bool operator()(ex::type::Price lhs, ex::type::Price rhs) const {
+            return lhs > rhs;
+        }
     };
 
     struct AscendingPriceOrdering {
-        bool operator()(const ex::state::OrderInfo& lhs, const ex::state::OrderInfo& rhs) {
+        bool operator()(const ex::state::OrderInfo& lhs, const ex::state::OrderInfo& rhs) const {
             return lhs.price < rhs.price;
         }
+        bool operator()(ex::type::Price lhs, ex::type::Price rhs) const {
+            return lhs < rhs;
+        }
     };
 
 
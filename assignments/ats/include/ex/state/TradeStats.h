@@ -0,0 +1,176 @@
+#pragma once
+#include "ex/type/Types.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace ex{ namespace state{
+
+    // Fixed capacity ring buffer. Once full, every push overwrites
+    //  (and hands back) the oldest element, so it never allocates.
+    //  Index 0 is the oldest element, size()-1 the newest.
+    template<typename T, std::size_t N>
+    struct RingBuffer {
+        static_assert( N > 0, "RingBuffer needs a non-zero capacity" );
+
+        // Returns true if an element was evicted to make room for 'item'
+        bool push(const T& item, T& evicted) {
+            bool full = ( count == N );
+            if( full ) {
+                evicted = items[head];
+                items[head] = item;
+                head = ( head + 1 ) % N;
+            } else {
+                items[ ( head + count ) % N ] = item;
+                ++count;
+            }
+            return full;
+        }
+
+        void push(const T& item) {
+            T evicted;
+            push( item, evicted );
+        }
+
+        T& back() { return items[ ( head + count - 1 ) % N ]; }
+        const T& back() const { return items[ ( head + count - 1 ) % N ]; }
+        const T& operator[](std::size_t i) const { return items[ ( head + i ) % N ]; }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        static constexpr std::size_t capacity() { return N; }
+    private:
+        std::array<T, N> items;
+        std::size_t head = 0;
+        std::size_t count = 0;
+    };
+
+    // Open-High-Low-Close bar along with the volume traded within the bar
+    struct Bar {
+        ex::type::Price open = 0.0;
+        ex::type::Price high = 0.0;
+        ex::type::Price low = 0.0;
+        ex::type::Price close = 0.0;
+        std::uint64_t volume = 0;
+        std::size_t tradeCount = 0;
+        std::chrono::nanoseconds startedAt = std::chrono::nanoseconds::zero(); // feed time of the first trade
+    };
+
+    // Rolling trade statistics for a single product. All statistics are
+    //  maintained incrementally on every trade, so every query is Theta(1).
+    //  Rolling window covers the last WindowSize trades and the last
+    //  BarHistory completed bars are kept.
+    //  Times are feed times, given by the caller with each trade, so that
+    //  a replay builds the same bars as the live session did.
+    struct TradeStats {
+        static constexpr std::size_t WindowSize = 64;
+        static constexpr std::size_t BarHistory = 32;
+
+        // Bars are closed either after 'tradesPerBar' trades or, when
+        //  'barInterval' is non-zero, once a trade arrives 'barInterval'
+        //  after the bar was opened. tradesPerBar must be non-zero for
+        //  count bars; a config without either is not valid.
+        struct Config {
+            std::size_t tradesPerBar = 100;
+            std::chrono::nanoseconds barInterval = std::chrono::nanoseconds::zero();
+
+            bool isValid() const { return tradesPerBar != 0 || barInterval > std::chrono::nanoseconds::zero(); }
+        };
+
+        TradeStats() = default;
+        // Pre-Condition: c.isValid()
+        explicit TradeStats(const Config& c) : config(c) {}
+
+        // 'at' is the feed time of the trade, only used by time bars
+        // TimeComplexity: O(1) - Amortized Cost
+        void notify(ex::type::Price price, ex::type::Quantity quantity, std::chrono::nanoseconds at) {
+            ++trades;
+            volume += quantity;
+            notional += price * quantity;
+
+            TradeEntry evicted;
+            if( window.push( TradeEntry{price, quantity}, evicted ) ) {
+                windowVol -= evicted.quantity;
+                windowNotional -= evicted.price * evicted.quantity;
+            }
+            windowVol += quantity;
+            windowNotional += price * quantity;
+            // Adding and taking out rounded products leaves an error behind
+            //  which would build up over a session: the sum is redone from
+            //  the window once per WindowSize trades, so it never carries
+            //  more than a window's worth.
+            if( trades % WindowSize == 0 ) resumWindow();
+
+            updateBar( price, quantity, at );
+        }
+
+        std::size_t tradeCount() const { return trades; } // TimeComplexity: Theta(1)
+        std::uint64_t totalVolume() const { return volume; } // TimeComplexity: Theta(1)
+        std::uint64_t windowVolume() const { return windowVol; } // TimeComplexity: Theta(1)
+
+        // TimeComplexity: Theta(1)
+        double vwap() const {
+            return volume == 0 ? 0.0 : notional / volume;
+        }
+
+        // TimeComplexity: Theta(1)
+        double windowVwap() const {
+            return windowVol == 0 ? 0.0 : windowNotional / windowVol;
+        }
+
+        // Bar currently being built. Valid only if hasOpenBar()
+        const Bar& currentBar() const { return bar; } // TimeComplexity: Theta(1)
+        bool hasOpenBar() const { return bar.tradeCount > 0; } // TimeComplexity: Theta(1)
+
+        // Completed bars, oldest first
+        const RingBuffer<Bar, BarHistory>& completedBars() const { return bars; } // TimeComplexity: Theta(1)
+
+    private:
+        struct TradeEntry {
+            ex::type::Price price;
+            ex::type::Quantity quantity;
+        };
+
+        Config config;
+
+        std::size_t trades = 0;
+        std::uint64_t volume = 0;
+        double notional = 0.0;
+
+        RingBuffer<TradeEntry, WindowSize> window;
+        std::uint64_t windowVol = 0;
+        double windowNotional = 0.0;
+
+        Bar bar;
+        RingBuffer<Bar, BarHistory> bars;
+
+        bool isTimeBased() const { return config.barInterval != std::chrono::nanoseconds::zero(); }
+
+        // TimeComplexity: Theta(WindowSize)
+        void resumWindow() {
+            windowNotional = 0.0;
+            for( std::size_t i = 0; i < window.size(); ++i ) windowNotional += window[i].price * window[i].quantity;
+        }
+
+        void updateBar(ex::type::Price price, ex::type::Quantity quantity, std::chrono::nanoseconds at) {
+            if( isTimeBased() && hasOpenBar() && at - bar.startedAt >= config.barInterval ) closeBar();
+
+            if( !hasOpenBar() ) {
+                bar.open = bar.high = bar.low = price;
+                bar.startedAt = at;
+            }
+            if( price > bar.high ) bar.high = price;
+            if( price < bar.low ) bar.low = price;
+            bar.close = price;
+            bar.volume += quantity;
+            ++bar.tradeCount;
+
+            if( !isTimeBased() && bar.tradeCount >= config.tradesPerBar ) closeBar();
+        }
+
+        void closeBar() {
+            bars.push( bar );
+            bar = Bar();
+        }
+    };
+}}
@@ -0,0 +1,264 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "ex/msg/Decoder.h"
+#include "ex/msg/NewOrder.h"
+#include "ex/msg/AmendOrder.h"
+#include "ex/msg/CancelOrder.h"
+#include "ex/msg/Trade.h"
+#include "ex/OrderBook.h"
+
+// Applies every decoded message to the book it currently points at and
+//  counts the messages applied so far, which is the sequence number of
+//  the last message seen.
+struct ApplyHandler {
+    ApplyHandler(ex::OrderBook& ob)
+        : orderBook(&ob)
+    {}
+
+    ApplyHandler(const ApplyHandler&) = delete;
+    ApplyHandler(ApplyHandler&&) = delete;
+    ApplyHandler& operator=(const ApplyHandler&) = delete;
+    ApplyHandler& operator=(ApplyHandler&&) = delete;
+
+    template<typename Msg>
+    void operator()(const Msg& obj) {
+        orderBook->notify( obj );
+        ++seqNo;
+    }
+
+    ex::OrderBook* orderBook;
+    std::size_t seqNo = 0;
+};
+
+struct Query {
+    ex::type::ProductId productId;
+    std::size_t seqNo;
+    std::size_t position; // position of the query in the batch
+};
+
+// Replays a feed held in memory and answers "what did the book of
+//  product P look like after message N" queries.
+//  While sweeping the feed, a copy of the book is taken every
+//  'interval' messages along with the offset of the next message in the
+//  feed. A query restores the nearest checkpoint at or before N and
+//  replays only the messages in between.
+//  Every checkpoint is a full copy of the book, so at most
+//  'maxCheckpoints' are kept: when one more is taken, every other one is
+//  dropped and the interval doubles. Memory stays within maxCheckpoints
+//  books while the replay cost of a query grows with the feed, as
+//  interval * 2^k for a feed of interval * maxCheckpoints * 2^k messages.
+struct CheckpointedFeed {
+    CheckpointedFeed(const std::string& feed, std::size_t checkpointInterval, std::size_t maxCheckpoints)
+        : in(feed)
+        , interval( std::max<std::size_t>( checkpointInterval, 1 ) )
+        , maxCount( std::max<std::size_t>( maxCheckpoints, 2 ) )
+    {
+        checkpoints.push_back( Checkpoint{ 0, 0, ex::OrderBook(), 0 } );
+    }
+
+    // Answers the queries with a single sweep over the feed, taking
+    //  checkpoints on the way.
+    // TimeComplexity: O(M + Q log Q) for M messages and Q queries
+    std::vector<std::string> sweep(std::vector<Query> queries, std::size_t level) {
+        std::sort( queries.begin(), queries.end(), [](const Query& lhs, const Query& rhs) {
+            return lhs.seqNo < rhs.seqNo;
+        });
+
+        std::vector<std::string> answers( queries.size() );
+        ex::OrderBook book;
+        ApplyHandler handler( book );
+        restart( 0 );
+        ex::msg::Decoder<ApplyHandler> decoder( in, handler );
+
+        auto query = queries.begin();
+        while( true ) {
+            while( query != queries.end() && query->seqNo <= handler.seqNo ) {
+                answers[ query->position ] = answer( book, *query, handler.seqNo, level );
+                ++query;
+            }
+            if( !decoder.hasMoreMessages() ) break;
+
+            auto before = handler.seqNo;
+            decoder.decode();
+            if( handler.seqNo != before && handler.seqNo % interval == 0 ) {
+                takeCheckpoint( book, handler.seqNo );
+            }
+        }
+        lastSeqNo = handler.seqNo;
+
+        for( ; query != queries.end(); ++query ) {
+            answers[ query->position ] = answer( book, *query, handler.seqNo, level );
+        }
+        return answers;
+    }
+
+    // Answers a single query from the nearest earlier checkpoint.
+    // Pre-Condition: sweep has been run
+    // TimeComplexity: O(log C + interval) for C checkpoints, with the
+    //  interval as doubled by the sweep
+    std::string query(const Query& q, std::size_t level) {
+        auto iter = std::upper_bound( checkpoints.begin(), checkpoints.end(), q.seqNo, [](std::size_t seqNo, const Checkpoint& c) {
+            return seqNo < c.seqNo;
+        });
+        const Checkpoint& checkpoint = *(--iter);
+
+        ex::OrderBook book = checkpoint.book;
+        ApplyHandler handler( book );
+        handler.seqNo = checkpoint.seqNo;
+        restart( checkpoint.offset );
+        ex::msg::Decoder<ApplyHandler> decoder( in, handler );
+        while( handler.seqNo < q.seqNo && decoder.hasMoreMessages() ) {
+            decoder.decode();
+        }
+
+        return answer( book, q, handler.seqNo, level );
+    }
+
+    std::size_t checkpointCount() const { return checkpoints.size(); }
+    std::size_t checkpointInterval() const { return interval; }
+    std::uint64_t checkpointBytes() const { return bytes; } // heap held by the checkpointed books
+    std::size_t messageCount() const { return lastSeqNo; }
+private:
+    struct Checkpoint {
+        std::size_t seqNo;
+        std::streamoff offset; // offset of message seqNo + 1 in the feed
+        ex::OrderBook book;
+        std::uint64_t bytes;   // heap taken by the copy of the book
+    };
+
+    std::istringstream in;
+    std::size_t interval;
+    std::size_t maxCount;
+    std::vector<Checkpoint> checkpoints;
+    std::uint64_t bytes = 0;
+    std::size_t lastSeqNo = 0;
+
+    // Copies the book, after thinning the checkpoints if they are full
+    // TimeComplexity: Theta(book), plus O(C) when thinning
+    void takeCheckpoint(const ex::OrderBook& book, std::size_t seqNo) {
+        if( checkpoints.size() == maxCount ) {
+            interval *= 2;
+            auto kept = std::remove_if( checkpoints.begin(), checkpoints.end(), [this](const Checkpoint& c) {
+                return c.seqNo % interval != 0;
+            });
+            for( auto iter = kept; iter != checkpoints.end(); ++iter ) bytes -= iter->bytes;
+            checkpoints.erase( kept, checkpoints.end() );
+            if( seqNo % interval != 0 ) return;
+        }
+        auto before = ex::mem::totalCurrentBytes();
+        checkpoints.push_back( Checkpoint{ seqNo, offset(), book, 0 } );
+        checkpoints.back().bytes = ex::mem::totalCurrentBytes() - before;
+        bytes += checkpoints.back().bytes;
+    }
+
+    std::streamoff offset() {
+        return in.eof() ? static_cast<std::streamoff>( in.str().size() ) : static_cast<std::streamoff>( in.tellg() );
+    }
+
+    void restart(std::streamoff off) {
+        in.clear();
+        in.seekg( off );
+    }
+
+    static std::string answer(ex::OrderBook& book, const Query& q, std::size_t seqNo, std::size_t level) {
+        std::ostringstream out;
+        out << "Product " << q.productId << " after message " << seqNo << std::endl;
+        book.print( out, q.productId, level, true );
+        return out.str();
+    }
+};
+
+// Reads queries of the form "<productId>,<seqNo>", one per line
+std::vector<Query> readQueries(std::istream& in)
+{
+    std::vector<Query> queries;
+    Query q;
+    char delim;
+    while( in >> q.productId >> delim >> q.seqNo ) {
+        q.position = queries.size();
+        queries.push_back( q );
+    }
+    return queries;
+}
+
+void printUsage(std::ostream& out)
+{
+    out << "[USAGE]: book_query <path/to/messages/file> [path/to/queries/file] [options]" << std::endl
+        << "    Queries are lines of <productId>,<seqNo>. A queries file is answered in a single sweep," << std::endl
+        << "    after which further queries are read from stdin and answered from checkpoints." << std::endl
+        << "    --interval <msgs>     messages between book checkpoints (default 10000)" << std::endl
+        << "    --max-checkpoints <n> checkpoints kept in memory (default 64). Each one is a full copy of" << std::endl
+        << "                          the book, so memory grows to about n books; beyond n checkpoints" << std::endl
+        << "                          every other one is dropped and the interval doubles" << std::endl
+        << "    --levels <n>          price levels to print per side (default 5)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "[ERROR]: Missing messages file name" << std::endl;
+        printUsage( std::cerr );
+        return -1;
+    }
+
+    std::size_t interval = 10000;
+    std::size_t maxCheckpoints = 64;
+    std::size_t level = 5;
+    const char* queriesFile = nullptr;
+    for( int i = 2; i < argc; ++i ) {
+        bool hasValue = i + 1 < argc;
+        if( std::strcmp( argv[i], "--interval" ) == 0 && hasValue ) {
+            interval = std::strtoul( argv[++i], nullptr, 10 );
+        } else if( std::strcmp( argv[i], "--max-checkpoints" ) == 0 && hasValue ) {
+            maxCheckpoints = std::strtoul( argv[++i], nullptr, 10 );
+        } else if( std::strcmp( argv[i], "--levels" ) == 0 && hasValue ) {
+            level = std::strtoul( argv[++i], nullptr, 10 );
+        } else if( argv[i][0] != '-' && queriesFile == nullptr ) {
+            queriesFile = argv[i];
+        } else {
+            std::cerr << "[ERROR]: Unknown option " << argv[i] << std::endl;
+            printUsage( std::cerr );
+            return -1;
+        }
+    }
+
+    std::ifstream ifile(argv[1]);
+    if( !ifile ) {
+        std::cerr << "[ERROR]: File specified at " << argv[1] << " doesnot exist" << std::endl;
+        return -2;
+    }
+    std::stringstream buffer;
+    buffer << ifile.rdbuf();
+
+    std::vector<Query> batch;
+    if( queriesFile != nullptr ) {
+        std::ifstream qfile(queriesFile);
+        if( !qfile ) {
+            std::cerr << "[ERROR]: File specified at " << queriesFile << " doesnot exist" << std::endl;
+            return -2;
+        }
+        batch = readQueries( qfile );
+    }
+
+    CheckpointedFeed feed( buffer.str(), interval, maxCheckpoints );
+    for(auto& answer: feed.sweep( batch, level ) ) {
+        std::cout << answer;
+    }
+    std::cerr << "Replayed " << feed.messageCount() << " messages, " << feed.checkpointCount() << " checkpoints every "
+              << feed.checkpointInterval() << " messages holding " << feed.checkpointBytes() << " bytes" << std::endl;
+
+    if( queriesFile == nullptr ) {
+        for(auto& q: readQueries( std::cin ) ) {
+            std::cout << feed.query( q, level );
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include "ex/msg/NewOrder.h"
+#include "ex/msg/AmendOrder.h"
+#include "ex/msg/CancelOrder.h"
+#include "ex/msg/Trade.h"
+
+// Writes a synthetic feed to stdout. The output only depends on the
+//  arguments: std::mt19937_64 is fully specified by the standard and its
+//  raw output is used directly (distributions are implementation defined).
+//  Roughly half of the messages are NewOrders, the rest are amends,
+//  cancels and trades against live orders, along with a small share of
+//  duplicate and unknown order ids to exercise the error paths.
+//  Bids and asks do not overlap, so a trade against a single live order
+//  is rejected by the book; half of the trades are instead preceded by an
+//  order priced through the spread at the live order's price, so that
+//  both sides rest at the traded price and the trade executes.
+struct FeedGenerator {
+    FeedGenerator(std::uint64_t seed, std::size_t productCount)
+        : random(seed)
+        , products(productCount)
+    {}
+
+    void generate(std::ostream& out, std::size_t messages) {
+        for( std::size_t i = 0; i < messages; ++i ) {
+            auto dice = next(100);
+            if( live.empty() || dice < 50 ) {
+                out << newOrder() << '\n';
+            } else if( dice < 65 ) {
+                out << amendOrder() << '\n';
+            } else if( dice < 80 ) {
+                out << cancelOrder() << '\n';
+            } else if( dice < 90 ) {
+                out << trade() << '\n';
+            } else {
+                ex::msg::Trade executed;
+                out << crossingOrder( executed ) << '\n';
+                if( ++i < messages ) out << executed << '\n';
+            }
+        }
+    }
+private:
+    struct LiveOrder {
+        ex::type::ProductId productId;
+        ex::type::OrderId orderId;
+        ex::type::Side side;
+        ex::type::Price price;
+    };
+
+    std::mt19937_64 random;
+    std::size_t products;
+    std::vector<LiveOrder> live;
+    ex::type::OrderId nextOrderId = 1000000;
+
+    std::uint64_t next(std::uint64_t bound) { return random() % bound; }
+
+    ex::type::Side side() { return next(2) == 0 ? ex::type::Side::Buy : ex::type::Side::Sell; }
+    ex::type::Quantity quantity() { return static_cast<ex::type::Quantity>( 1 + next(100) ); }
+
+    // Bids cluster below 1000 and asks above it, 5 per tick
+    ex::type::Price price(ex::type::Side s) {
+        auto ticks = static_cast<ex::type::Price>( next(20) );
+        return s == ex::type::Side::Buy ? 995 - ticks * 5 : 1005 + ticks * 5;
+    }
+
+    std::size_t pickLive() { return static_cast<std::size_t>( next( live.size() ) ); }
+
+    ex::msg::NewOrder newOrder() {
+        ex::msg::NewOrder obj;
+        obj.productId = 1 + next( products );
+        obj.side = side();
+        obj.quantity = quantity();
+        obj.price = price( obj.side );
+        obj.orderId = ( next(100) == 0 && !live.empty() ) ? live[ pickLive() ].orderId : nextOrderId++;
+        live.push_back( LiveOrder{ obj.productId, obj.orderId, obj.side, obj.price } );
+        return obj;
+    }
+
+    ex::msg::AmendOrder amendOrder() {
+        auto& order = live[ pickLive() ];
+        ex::msg::AmendOrder obj;
+        obj.orderId = next(100) == 0 ? nextOrderId + 1000000 : order.orderId;
+        obj.side = order.side;
+        obj.quantity = quantity();
+        obj.price = next(2) == 0 ? order.price : price( order.side );
+        order.price = obj.price;
+        return obj;
+    }
+
+    ex::msg::CancelOrder cancelOrder() {
+        auto idx = pickLive();
+        auto order = live[idx];
+        live[idx] = live.back();
+        live.pop_back();
+
+        ex::msg::CancelOrder obj;
+        obj.orderId = order.orderId;
+        obj.side = order.side;
+        obj.quantity = 0;
+        obj.price = order.price;
+        return obj;
+    }
+
+    ex::msg::Trade trade() {
+        auto& order = live[ pickLive() ];
+        ex::msg::Trade obj;
+        obj.productId = order.productId;
+        obj.quantity = quantity();
+        obj.price = order.price;
+        return obj;
+    }
+
+    // A NewOrder on the other side of a live order and at its price, along
+    //  with the trade between the two
+    ex::msg::NewOrder crossingOrder(ex::msg::Trade& executed) {
+        auto order = live[ pickLive() ];
+        ex::msg::NewOrder obj;
+        obj.productId = order.productId;
+        obj.side = order.side == ex::type::Side::Buy ? ex::type::Side::Sell : ex::type::Side::Buy;
+        obj.quantity = quantity();
+        obj.price = order.price;
+        obj.orderId = nextOrderId++;
+        live.push_back( LiveOrder{ obj.productId, obj.orderId, obj.side, obj.price } );
+
+        executed.productId = obj.productId;
+        executed.quantity = obj.quantity;
+        executed.price = obj.price;
+        return obj;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 4) {
+        std::cerr << "[ERROR]: Missing number of messages" << std::endl
+                << "[USAGE]: feed_gen <messages> [seed] [products]" << std::endl;
+        return -1;
+    }
+
+    std::size_t messages = std::strtoul( argv[1], nullptr, 10 );
+    std::uint64_t seed = argc > 2 ? std::strtoull( argv[2], nullptr, 10 ) : 1;
+    std::size_t products = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 8;
+
+    FeedGenerator generator( seed, std::max<std::size_t>( products, 1 ) );
+    generator.generate( std::cout, messages );
+
+    return 0;
+}
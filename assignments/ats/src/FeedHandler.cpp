@@ -1,7 +1,12 @@
 #include <fstream>
 #include <iostream>
 #include <functional>
-#include <deque>
+#include <array>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
 
 #include "ex/msg/Decoder.h"
 #include "ex/msg/NewOrder.h"
@@ -10,28 +15,70 @@
 #include "ex/msg/Trade.h"
 #include "ex/OrderBook.h"
 
-struct NewOrderError {
-    ex::type::ErrorCode err;
-    ex::msg::NewOrder obj;
-};
+// Every ErrorCode other than Unknown maps to its own slot, Unknown (and
+//  anything unexpected) shares the last one.
+constexpr std::size_t ErrorSlots = static_cast<std::size_t>(ex::type::ErrorCode::CorruptMessage) + 2;
 
-struct AmendOrderError {
-    ex::type::ErrorCode err;
-    ex::msg::AmendOrder obj;
-};
+std::size_t errorSlot(ex::type::ErrorCode err) {
+    auto slot = static_cast<std::size_t>(err);
+    return slot < ErrorSlots - 1 ? slot : ErrorSlots - 1;
+}
 
-struct CancelOrderError {
-    ex::type::ErrorCode err;
-    ex::msg::CancelOrder obj;
-};
+ex::type::ErrorCode errorOfSlot(std::size_t slot) {
+    return slot < ErrorSlots - 1 ? static_cast<ex::type::ErrorCode>(slot) : ex::type::ErrorCode::Unknown;
+}
+
+// Keeps a count of the errors seen for a single message type, broken down
+//  by ErrorCode, along with a uniform reservoir sample of at most
+//  SampleSize offending messages per ErrorCode. Memory use is fixed no
+//  matter how many errors are reported.
+template<typename Msg, std::size_t SampleSize = 4>
+struct ErrorSampler {
+    // TimeComplexity: Theta(1)
+    template<typename Random>
+    void notify(ex::type::ErrorCode err, const Msg& obj, Random& random) {
+        auto& reservoir = reservoirs[ errorSlot(err) ];
+        std::uint64_t seen = reservoir.count++;
+        if( seen < SampleSize ) {
+            reservoir.samples[seen] = obj;
+        } else {
+            std::uint64_t pick = std::uniform_int_distribution<std::uint64_t>(0, seen)( random );
+            if( pick < SampleSize ) reservoir.samples[pick] = obj;
+        }
+    }
 
-struct TradeError {
-    ex::type::ErrorCode err;
-    ex::msg::Trade obj;
+    std::uint64_t count(std::size_t slot) const { return reservoirs[slot].count; }
+
+    std::uint64_t total() const {
+        std::uint64_t n = 0;
+        for(auto& r: reservoirs ) n += r.count;
+        return n;
+    }
+
+    void printSamples(std::ostream& out) const {
+        for( std::size_t slot = 0; slot < ErrorSlots; ++slot ) {
+            auto& reservoir = reservoirs[slot];
+            std::size_t n = reservoir.count < SampleSize ? reservoir.count : SampleSize;
+            for( std::size_t i = 0; i < n; ++i ) {
+                out << "\"" << errorOfSlot(slot) << "\" occuerred while processing " << reservoir.samples[i] << std::endl;
+            }
+        }
+    }
+private:
+    struct Reservoir {
+        std::uint64_t count = 0;
+        std::array<Msg, SampleSize> samples;
+    };
+    std::array<Reservoir, ErrorSlots> reservoirs;
 };
 
 struct DecodeHandler {
-    DecodeHandler(ex::OrderBook& ob): orderBook(ob)
+    // errorReportInterval: number of messages between error reports printed
+    //  while running, 0 reports only during exit
+    DecodeHandler(ex::OrderBook& ob, std::size_t errorReportInterval = 0)
+        : orderBook(ob)
+        , reportInterval(errorReportInterval)
+        , lastReportedAt(std::chrono::steady_clock::now())
     {}
 
     DecodeHandler(const DecodeHandler&) = delete; 
@@ -42,33 +89,37 @@ struct DecodeHandler {
     DecodeHandler& operator=(DecodeHandler&&) = delete;
 
     void operator()(const ex::msg::NewOrder& obj) {
+        onMessage();
         std::cout << "RCVD: " << obj << std::endl;
         auto err = orderBook.notify( obj );
         if( err != ex::type::ErrorCode::Ok ) 
-            newOrderErrors.push_back( {err, obj} );
+            newOrderErrors.notify( err, obj, random );
         else 
             printOrderBook();
     }
     void operator()(const ex::msg::AmendOrder& obj) {
+        onMessage();
         auto err = orderBook.notify( obj );
         if( err != ex::type::ErrorCode::Ok ) 
-            amendOrderErrors.push_back( {err, obj} );
+            amendOrderErrors.notify( err, obj, random );
         else
             printOrderBook();
     }
 
     void operator()(const ex::msg::CancelOrder& obj) {
+        onMessage();
         auto err = orderBook.notify( obj );
         if( err != ex::type::ErrorCode::Ok ) 
-            cancelOrderErrors.push_back( {err, obj} );
+            cancelOrderErrors.notify( err, obj, random );
         else
             printOrderBook();
     }
 
     void operator()(const ex::msg::Trade& obj) {
+        onMessage();
         auto err = orderBook.notify( obj );
         if( err != ex::type::ErrorCode::Ok ) {
-            tradeErrors.push_back( {err, obj} );
+            tradeErrors.notify( err, obj, random );
         } else {
             printTrade(obj);
             printOrderBook();
@@ -77,20 +128,96 @@ struct DecodeHandler {
 
     ~DecodeHandler() {
         std::cout << "Error Summary during exit" << std::endl;
-        printAllErrors();
+        printErrorReport( std::cout, false );
         std::cout << "Order Book Summary during exit" << std::endl;
         orderBook.print( std::cout, 5, true); 
+        std::cout << "Memory Summary during exit" << std::endl;
+        printMemoryReport( std::cout );
+    }
+
+    // Prints order and level counts per product, heap usage per subsystem
+    //  and the number of allocations per message
+    void printMemoryReport(std::ostream& out) {
+        orderBook.printFootprint( out );
+        out << "Error samples: " << sizeof(newOrderErrors) + sizeof(amendOrderErrors) + sizeof(cancelOrderErrors) + sizeof(tradeErrors)
+            << " bytes, fixed" << std::endl;
+        out << std::fixed << std::setprecision(3)
+            << ( messagesSeen == 0 ? 0.0 : static_cast<double>( ex::mem::totalAllocations() ) / messagesSeen )
+            << " allocations per message" << std::endl;
+        out.unsetf( std::ios_base::floatfield );
+        out << std::setprecision(6);
+    }
+
+    // Prints error counts per ErrorCode and message type, the share of
+    //  messages rejected and the sampled offending messages. withRate adds
+    //  the number of errors per second since the previous report.
+    void printErrorReport(std::ostream& out, bool withRate) {
+        out << std::setw(34) << std::left << "Error"
+            << std::setw(10) << "New"
+            << std::setw(10) << "Amend"
+            << std::setw(10) << "Cancel"
+            << std::setw(10) << "Trade" << std::endl;
+        for( std::size_t slot = 0; slot < ErrorSlots; ++slot ) {
+            auto n = newOrderErrors.count(slot);
+            auto a = amendOrderErrors.count(slot);
+            auto c = cancelOrderErrors.count(slot);
+            auto t = tradeErrors.count(slot);
+            if( n + a + c + t == 0 ) continue;
+
+            std::ostringstream name;
+            name << errorOfSlot(slot);
+            out << std::setw(34) << std::left << name.str()
+                << std::setw(10) << n
+                << std::setw(10) << a
+                << std::setw(10) << c
+                << std::setw(10) << t << std::endl;
+        }
+
+        auto errors = totalErrors();
+        out << errors << " errors in " << messagesSeen << " messages";
+        if( withRate ) {
+            auto now = std::chrono::steady_clock::now();
+            double sinceLastReport = std::chrono::duration<double>( now - lastReportedAt ).count();
+            if( sinceLastReport > 0.0 ) {
+                out << ", " << ( errors - errorsAtLastReport ) / sinceLastReport << " errors/sec since last report";
+            }
+            lastReportedAt = now;
+            errorsAtLastReport = errors;
+        }
+        out << std::endl;
+
+        newOrderErrors.printSamples( out );
+        amendOrderErrors.printSamples( out );
+        cancelOrderErrors.printSamples( out );
+        tradeErrors.printSamples( out );
     }
 private:
     ex::OrderBook& orderBook;
 
-    std::deque<NewOrderError> newOrderErrors;
-    std::deque<AmendOrderError> amendOrderErrors;
-    std::deque<CancelOrderError> cancelOrderErrors;
-    std::deque<TradeError> tradeErrors;
+    ErrorSampler<ex::msg::NewOrder> newOrderErrors;
+    ErrorSampler<ex::msg::AmendOrder> amendOrderErrors;
+    ErrorSampler<ex::msg::CancelOrder> cancelOrderErrors;
+    ErrorSampler<ex::msg::Trade> tradeErrors;
+    std::minstd_rand random;
 
     std::size_t msgCount = 0;
 
+    std::size_t reportInterval;
+    std::uint64_t messagesSeen = 0;
+    std::chrono::steady_clock::time_point lastReportedAt;
+    std::uint64_t errorsAtLastReport = 0;
+
+    void onMessage() {
+        ++messagesSeen;
+        if( reportInterval != 0 && messagesSeen % reportInterval == 0 ) {
+            std::cout << "Error Summary after receiveing " << messagesSeen << " messages" << std::endl;
+            printErrorReport( std::cout, true );
+            std::cout << "Memory Summary after receiveing " << messagesSeen << " messages" << std::endl;
+            printMemoryReport( std::cout );
+            std::cout << std::endl;
+        }
+    }
+
     void printOrderBook() {
         if( ++msgCount == 10 ) {
             std::cout << "Summary after receiveing 10 messages" << std::endl;
@@ -106,31 +233,19 @@ private:
         std::cout << "Product " << obj.productId << ":" << priceQty.second << "@" << priceQty.first << std::endl;;
     }
 
-    template<typename Errors>
-    void printErrors(Errors& errors) {
-        for(auto& e: errors ) {
-            std::cout << "\"" << e.err << "\" occuerred while processing " << e.obj << std::endl;
-        }
-
-        errors.clear();
-    }
-
-    void printAllErrors() {
-        printErrors( newOrderErrors );
-        printErrors( amendOrderErrors );
-        printErrors( cancelOrderErrors );
-        printErrors( tradeErrors );
+    std::uint64_t totalErrors() const {
+        return newOrderErrors.total() + amendOrderErrors.total() + cancelOrderErrors.total() + tradeErrors.total();
     }
-
 };
 
 int main(int argc, char** argv)
 {
-    if (argc != 2) {
+    if (argc != 2 && argc != 3) {
         std::cerr << "[ERROR]: Missing messages file name" << std::endl
-                << "[USAGE]: feed_handler <path/to/messages/file" << std::endl;
+                << "[USAGE]: feed_handler <path/to/messages/file [error report interval in messages]" << std::endl;
         return -1;
     }
+    std::size_t errorReportInterval = argc == 3 ? std::strtoul( argv[2], nullptr, 10 ) : 0;
 
     std::ifstream ifile(argv[1]);
     if( !ifile ) {
@@ -138,7 +253,7 @@ int main(int argc, char** argv)
         return -2;
     }
     ex::OrderBook orderBook;
-    DecodeHandler dh(orderBook);
+    DecodeHandler dh(orderBook, errorReportInterval);
 
     ex::msg::Decoder<DecodeHandler> decoder(ifile, std::ref(dh) );
 
@@ -0,0 +1,299 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "ex/msg/Decoder.h"
+#include "ex/msg/NewOrder.h"
+#include "ex/msg/AmendOrder.h"
+#include "ex/msg/CancelOrder.h"
+#include "ex/msg/Trade.h"
+#include "ex/OrderBook.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Load profile for a single replay run.
+//  rate is the target number of messages per second (0 => flat out),
+//  speedUp multiplies that rate and burst groups messages which are
+//  released back-to-back at the start of each burst slot.
+struct ReplayProfile {
+    double rate = 0.0;
+    double speedUp = 1.0;
+    std::size_t burst = 1;
+    std::size_t loops = 1;
+    bool bulkLoad = false;
+};
+
+struct ReplayResult {
+    std::size_t messages = 0;
+    double elapsedSeconds = 0.0;
+    std::vector<std::uint64_t> latencies; // nanoseconds, one per handled message
+    std::size_t bulkLoadedMessages = 0;
+    double bulkLoadSeconds = 0.0;
+
+    double achievedRate() const {
+        return elapsedSeconds > 0.0 ? messages / elapsedSeconds : 0.0;
+    }
+
+    // Pre-Condition: latencies are sorted
+    std::uint64_t percentile(double p) const {
+        if( latencies.empty() ) return 0;
+        std::size_t idx = static_cast<std::size_t>( p / 100.0 * (latencies.size() - 1) + 0.5 );
+        return latencies[ std::min( idx, latencies.size() - 1 ) ];
+    }
+};
+
+// Decode handler which pushes every message into the book and records
+//  the end-to-end latency of the message against the time it was
+//  scheduled to arrive. Measuring against the schedule (and not against
+//  the time decode started) keeps queueing delay in the numbers when the
+//  handler falls behind the offered load.
+//  With bulk loading enabled, the leading run of NewOrders is buffered
+//  and handed to OrderBook::load in one go as soon as the first other
+//  message arrives; processing is incremental from then on.
+struct ReplayHandler {
+    ReplayHandler(ex::OrderBook& ob, ReplayResult& r)
+        : orderBook(&ob)
+        , result(r)
+    {}
+
+    ReplayHandler(const ReplayHandler&) = delete;
+    ReplayHandler(ReplayHandler&&) = delete;
+    ReplayHandler& operator=(const ReplayHandler&) = delete;
+    ReplayHandler& operator=(ReplayHandler&&) = delete;
+
+    void operator()(const ex::msg::NewOrder& obj) {
+        if( bulkLoading ) {
+            pending.push_back( obj );
+            ++handled;
+            return;
+        }
+        process( obj );
+    }
+
+    template<typename Msg>
+    void operator()(const Msg& obj) {
+        flush();
+        process( obj );
+    }
+
+    void flush() {
+        if( !bulkLoading ) return;
+        bulkLoading = false;
+
+        auto start = Clock::now();
+        orderBook->load( pending );
+        result.bulkLoadSeconds += std::chrono::duration<double>( Clock::now() - start ).count();
+        result.bulkLoadedMessages += pending.size();
+        pending.clear();
+    }
+
+    void reset(ex::OrderBook& ob, bool bulkLoad) {
+        orderBook = &ob;
+        bulkLoading = bulkLoad;
+    }
+
+    Clock::time_point scheduledAt;
+    std::size_t handled = 0;
+    bool bulkLoading = false;
+private:
+    ex::OrderBook* orderBook;
+    ReplayResult& result;
+    std::vector<ex::msg::NewOrder> pending;
+
+    template<typename Msg>
+    void process(const Msg& obj) {
+        orderBook->notify( obj );
+        auto now = Clock::now();
+        result.latencies.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( now - scheduledAt ).count() );
+        ++handled;
+    }
+};
+
+// Replays the feed held in 'feed' according to 'profile'. A fresh book is
+//  used for every loop so that repeated loops see the same book states.
+ReplayResult replay(const std::string& feed, const ReplayProfile& profile)
+{
+    ReplayResult result;
+    std::size_t lines = std::count( feed.begin(), feed.end(), '\n' ) + 1;
+    result.latencies.reserve( lines * profile.loops );
+
+    const double effectiveRate = profile.rate * profile.speedUp;
+    const std::size_t burst = std::max<std::size_t>( profile.burst, 1 );
+    const Clock::duration burstInterval = effectiveRate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( burst / effectiveRate ) )
+        : Clock::duration::zero();
+
+    std::vector<ex::OrderBook> books( profile.loops );
+    ReplayHandler handler( books.front(), result );
+
+    std::istringstream in( feed );
+    ex::msg::Decoder<ReplayHandler> decoder( in, handler );
+
+    const Clock::time_point start = Clock::now();
+    for( std::size_t loop = 0; loop < profile.loops; ++loop ) {
+        handler.reset( books[loop], profile.bulkLoad );
+        in.clear();
+        in.seekg( 0 );
+
+        while( decoder.hasMoreMessages() ) {
+            std::size_t seq = handler.handled;
+            handler.scheduledAt = start + burstInterval * static_cast<Clock::rep>( seq / burst );
+            if( effectiveRate > 0.0 && !handler.bulkLoading ) {
+                while( Clock::now() < handler.scheduledAt ) {} //Busy wait until the message is due
+            } else {
+                handler.scheduledAt = Clock::now();
+            }
+            decoder.decode();
+        }
+        handler.flush();
+    }
+    result.elapsedSeconds = std::chrono::duration<double>( Clock::now() - start ).count();
+    result.messages = handler.handled;
+
+    std::sort( result.latencies.begin(), result.latencies.end() );
+    return result;
+}
+
+void printHeader(std::ostream& out)
+{
+    out << std::setw(14) << std::left << "TargetRate"
+        << std::setw(14) << "Achieved"
+        << std::setw(10) << "Msgs"
+        << std::setw(10) << "p50(ns)"
+        << std::setw(10) << "p90(ns)"
+        << std::setw(10) << "p99(ns)"
+        << std::setw(12) << "p99.9(ns)"
+        << std::setw(12) << "max(ns)" << std::endl;
+}
+
+void printResult(std::ostream& out, double targetRate, const ReplayResult& r)
+{
+    out << std::setw(14) << std::left << static_cast<std::uint64_t>(targetRate)
+        << std::setw(14) << static_cast<std::uint64_t>( r.achievedRate() )
+        << std::setw(10) << r.messages
+        << std::setw(10) << r.percentile(50)
+        << std::setw(10) << r.percentile(90)
+        << std::setw(10) << r.percentile(99)
+        << std::setw(12) << r.percentile(99.9)
+        << std::setw(12) << ( r.latencies.empty() ? 0 : r.latencies.back() ) << std::endl;
+}
+
+// A rate is sustainable when the handler keeps up with the offered load
+//  and the tail latency stays under the given budget.
+bool isSustainable(const ReplayResult& r, double targetRate, std::uint64_t p99BudgetNs)
+{
+    return r.achievedRate() >= 0.95 * targetRate && r.percentile(99) <= p99BudgetNs;
+}
+
+// Doubles the offered rate until it is no longer sustainable and then
+//  bisects between the last good and the first bad rate.
+double findMaxSustainableRate(const std::string& feed, ReplayProfile profile, std::uint64_t p99BudgetNs)
+{
+    double good = 0.0;
+    double bad = 0.0;
+    double rate = 10000.0;
+
+    printHeader( std::cout );
+    while( bad == 0.0 ) {
+        profile.rate = rate;
+        auto r = replay( feed, profile );
+        double offered = rate * profile.speedUp;
+        printResult( std::cout, offered, r );
+        if( isSustainable( r, offered, p99BudgetNs ) ) {
+            good = rate;
+            rate *= 2;
+        } else {
+            bad = rate;
+        }
+    }
+
+    for( int i = 0; i < 6; ++i ) {
+        rate = ( good + bad ) / 2;
+        profile.rate = rate;
+        auto r = replay( feed, profile );
+        double offered = rate * profile.speedUp;
+        printResult( std::cout, offered, r );
+        if( isSustainable( r, offered, p99BudgetNs ) ) good = rate; else bad = rate;
+    }
+
+    return good * profile.speedUp;
+}
+
+void printUsage(std::ostream& out)
+{
+    out << "[USAGE]: feed_replay <path/to/messages/file> [options]" << std::endl
+        << "    --rate <msgs/sec>     offered message rate, 0 replays flat out (default 0)" << std::endl
+        << "    --speedup <factor>    multiplies the offered rate, e.g. 10 for 10x (default 1)" << std::endl
+        << "    --burst <msgs>        release messages in back-to-back bursts of this size (default 1)" << std::endl
+        << "    --loops <n>           replay the file n times, each into a fresh book (default 1)" << std::endl
+        << "    --bulk-load           bulk-load the leading NewOrders of the file before replaying the rest" << std::endl
+        << "    --find-max            search for the highest sustainable rate" << std::endl
+        << "    --p99-budget <ns>     p99 latency budget used by --find-max (default 100000)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "[ERROR]: Missing messages file name" << std::endl;
+        printUsage( std::cerr );
+        return -1;
+    }
+
+    ReplayProfile profile;
+    bool findMax = false;
+    std::uint64_t p99BudgetNs = 100000;
+    for( int i = 2; i < argc; ++i ) {
+        bool hasValue = i + 1 < argc;
+        if( std::strcmp( argv[i], "--rate" ) == 0 && hasValue ) {
+            profile.rate = std::atof( argv[++i] );
+        } else if( std::strcmp( argv[i], "--speedup" ) == 0 && hasValue ) {
+            profile.speedUp = std::atof( argv[++i] );
+        } else if( std::strcmp( argv[i], "--burst" ) == 0 && hasValue ) {
+            profile.burst = std::strtoul( argv[++i], nullptr, 10 );
+        } else if( std::strcmp( argv[i], "--loops" ) == 0 && hasValue ) {
+            profile.loops = std::max<std::size_t>( std::strtoul( argv[++i], nullptr, 10 ), 1 );
+        } else if( std::strcmp( argv[i], "--p99-budget" ) == 0 && hasValue ) {
+            p99BudgetNs = std::strtoull( argv[++i], nullptr, 10 );
+        } else if( std::strcmp( argv[i], "--bulk-load" ) == 0 ) {
+            profile.bulkLoad = true;
+        } else if( std::strcmp( argv[i], "--find-max" ) == 0 ) {
+            findMax = true;
+        } else {
+            std::cerr << "[ERROR]: Unknown option " << argv[i] << std::endl;
+            printUsage( std::cerr );
+            return -1;
+        }
+    }
+
+    std::ifstream ifile(argv[1]);
+    if( !ifile ) {
+        std::cerr << "[ERROR]: File specified at " << argv[1] << " doesnot exist" << std::endl;
+        return -2;
+    }
+    std::stringstream buffer;
+    buffer << ifile.rdbuf();
+    const std::string feed = buffer.str();
+
+    if( findMax ) {
+        double maxRate = findMaxSustainableRate( feed, profile, p99BudgetNs );
+        std::cout << "Max sustainable rate: " << static_cast<std::uint64_t>(maxRate)
+                  << " msgs/sec (p99 <= " << p99BudgetNs << "ns)" << std::endl;
+    } else {
+        auto r = replay( feed, profile );
+        printHeader( std::cout );
+        printResult( std::cout, profile.rate * profile.speedUp, r );
+        if( profile.bulkLoad ) {
+            std::cout << "Bulk loaded " << r.bulkLoadedMessages << " orders in "
+                      << static_cast<std::uint64_t>( r.bulkLoadSeconds * 1e6 ) << "us" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -1,16 +1,9 @@
 #include "ex/OrderBook.h"
 #include "ex/state/OrderInfo.h"
 #include <algorithm>
+#include <future>
+#include <thread>
 
-template<typename Book>
-void printAll(std::ostream& out, Book& book) 
-{
-    out << "[";
-    for(auto& x: book ) {
-        out << x.orderId << ":" << x.quantity << "@" << x.price << " ";
-    }
-    out << "]" << std::endl;
-}
 void printHeaders(std::ostream& out, std::size_t uptoLevel)
 {
     out << std::setw(10) << std::left << "Product";
@@ -23,20 +16,20 @@ void printHeaders(std::ostream& out, std::size_t uptoLevel)
         out << std::setw(10) << (columnName + std::to_string(i));
     } 
 }
-template<typename OrderInfoSet>
-void printPricePoints(std::ostream& out, OrderInfoSet& infoSet, std::size_t uptoLevel) 
+// Prints up to uptoLevel price levels, best first. Blank columns are
+//  padded based on the number of orders on the side.
+template<typename BookSide>
+void printPricePoints(std::ostream& out, const BookSide& side, std::size_t uptoLevel) 
 {
-    std::size_t i = std::min( uptoLevel, infoSet.size() );
-    auto infoSetIter = infoSet.begin();
-    while( infoSetIter != infoSet.end() && i > 0 ) {
-        out << std::setw(10) << std::left << infoSetIter->price;
+    std::size_t i = std::min( uptoLevel, side.orderCount() );
+    side.forEachPrice( [&](ex::type::Price price) {
+        if( i == 0 ) return;
+        out << std::setw(10) << std::left << price;
         i--;
-        //Skip to next price level
-        infoSetIter = infoSet.upper_bound( *infoSetIter );
-    }
+    });
 
-    if( infoSet.size() < uptoLevel ) {
-        for(std::size_t  blankEntries = uptoLevel - infoSet.size(); blankEntries > 0; blankEntries-- ) {
+    if( side.orderCount() < uptoLevel ) {
+        for(std::size_t  blankEntries = uptoLevel - side.orderCount(); blankEntries > 0; blankEntries-- ) {
             out << std::setw(10) << std::left << "-";
         }
     }
@@ -50,71 +43,198 @@ void ex::OrderBook::print(std::ostream& out, std::size_t level, bool printHeader
     }
 
     for(auto& product: products) {
-        out << std::setw(10) << std::left << product;
-        printPricePoints( out, buys[product], level );
-        printPricePoints( out, sells[product], level );
+        printProduct( out, product, level );
+    }
+}
+
+void ex::OrderBook::print(std::ostream& out, ex::type::ProductId product, std::size_t level, bool printHeader) 
+{
+    if( printHeader ) {
+        printHeaders(out, level);
         out << std::endl;
     }
+
+    if( products.find( product ) != products.end() ) {
+        printProduct( out, product, level );
+    }
 }
-ex::type::ErrorCode ex::OrderBook::notify(const ex::msg::NewOrder& obj)
+
+ex::OrderBook::ProductFootprint ex::OrderBook::getFootprint(ex::type::ProductId productId) const
 {
-    if ( orderExists( obj.orderId ) ) return ex::type::ErrorCode::DuplicateOrderId;
+    ProductFootprint footprint;
+    auto iter = books.find( productId );
+    if( iter != books.end() ) {
+        auto& book = iter->second;
+        footprint.bidOrders = book.buys.orderCount();
+        footprint.askOrders = book.sells.orderCount();
+        footprint.bidLevels = book.buys.levelCount();
+        footprint.askLevels = book.sells.levelCount();
+        footprint.zeroQuantityOrders = book.buys.zeroQuantityOrderCount() + book.sells.zeroQuantityOrderCount();
+    }
+    return footprint;
+}
 
-    ex::state::OrderInfo ord;
-    ord.orderId = obj.orderId;
-    ord.price = obj.price;
-    ord.quantity = obj.quantity;
+void ex::OrderBook::printFootprint(std::ostream& out) const
+{
+    out << std::setw(10) << std::left << "Product"
+        << std::setw(12) << "BidOrders"
+        << std::setw(12) << "AskOrders"
+        << std::setw(12) << "BidLevels"
+        << std::setw(12) << "AskLevels"
+        << std::setw(12) << "ZeroQty" << std::endl;
+    for(auto& product: products) {
+        auto footprint = getFootprint( product );
+        out << std::setw(10) << std::left << product
+            << std::setw(12) << footprint.bidOrders
+            << std::setw(12) << footprint.askOrders
+            << std::setw(12) << footprint.bidLevels
+            << std::setw(12) << footprint.askLevels
+            << std::setw(12) << footprint.zeroQuantityOrders << std::endl;
+    }
+    out << orderIndex.size() << " order ids indexed" << std::endl;
+    ex::mem::printAllocationStats( out );
+}
 
+void ex::OrderBook::printProduct(std::ostream& out, ex::type::ProductId product, std::size_t level) 
+{
+    auto& book = books[product];
+    out << std::setw(10) << std::left << product;
+    printPricePoints( out, book.buys, level );
+    printPricePoints( out, book.sells, level );
+    out << std::endl;
+}
+ex::type::ErrorCode ex::OrderBook::notify(const ex::msg::NewOrder& obj)
+{
+    auto inserted = orderIndex.emplace( obj.orderId, OrderEntry{ obj.productId, obj.side, ex::state::OrderLocation() } );
+    if ( !inserted.second ) return ex::type::ErrorCode::DuplicateOrderId;
 
-    products.emplace( obj.productId );
-    orderIdToProductIdMap[obj.orderId] = obj.productId;
+    products.insert( obj.productId );
 
+    auto& book = books[obj.productId];
+    auto& entry = inserted.first->second;
     if( obj.side == ex::type::Side::Buy ) {
-        buys[obj.productId].emplace( ord );
+        entry.location = book.buys.add( obj.orderId, obj.quantity, obj.price, ++entrySeq );
     } else {
-        sells[obj.productId].emplace( ord );
+        entry.location = book.sells.add( obj.orderId, obj.quantity, obj.price, ++entrySeq );
     }
 
     return ex::type::ErrorCode::Ok;
 }
 
+std::vector<ex::type::ErrorCode> ex::OrderBook::load(const std::vector<ex::msg::NewOrder>& orders, unsigned threads)
+{
+    struct Batch {
+        ProductBook* book;
+        std::vector<BatchEntry> buys;
+        std::vector<BatchEntry> sells;
+    };
+
+    std::vector<ex::type::ErrorCode> errors( orders.size(), ex::type::ErrorCode::Ok );
+    std::vector<Batch> batches;
+    std::unordered_map<ex::type::ProductId, std::size_t> batchOfProduct;
+
+    // Validation and order-id index updates happen in arrival order, so
+    //  duplicates are detected exactly as with incremental processing.
+    //  Index entries are filled in with the order locations by the workers;
+    //  references into the index stay valid as it grows.
+    orderIndex.reserve( orderIndex.size() + orders.size() );
+    for( std::size_t i = 0; i < orders.size(); ++i ) {
+        auto& obj = orders[i];
+        auto inserted = orderIndex.emplace( obj.orderId, OrderEntry{ obj.productId, obj.side, ex::state::OrderLocation() } );
+        if( !inserted.second ) {
+            errors[i] = ex::type::ErrorCode::DuplicateOrderId;
+            continue;
+        }
+
+        // Every book is created up front so that the workers never modify
+        //  the product maps and only ever touch their own book sides
+        auto batchIter = batchOfProduct.find( obj.productId );
+        if( batchIter == batchOfProduct.end() ) {
+            batchIter = batchOfProduct.emplace( obj.productId, batches.size() ).first;
+            batches.push_back( Batch{ &books[obj.productId], {}, {} } );
+            products.insert( obj.productId );
+        }
+
+        ex::state::OrderInfo ord;
+        ord.orderId = obj.orderId;
+        ord.price = obj.price;
+        ord.quantity = obj.quantity;
+
+        auto& batch = batches[ batchIter->second ];
+        BatchEntry entry{ ord, ++entrySeq, &inserted.first->second };
+        if( obj.side == ex::type::Side::Buy ) {
+            batch.buys.push_back( entry );
+        } else {
+            batch.sells.push_back( entry );
+        }
+    }
+
+    if( threads == 0 ) threads = std::max( std::thread::hardware_concurrency(), 1u );
+    threads = static_cast<unsigned>( std::min<std::size_t>( threads, batches.size() * 2 ) );
+
+    auto work = [&](unsigned worker) {
+        for( std::size_t i = worker; i < batches.size() * 2; i += threads ) {
+            auto& batch = batches[i / 2];
+            if( i % 2 == 0 ) {
+                bulkInsert( batch.book->buys, batch.buys );
+            } else {
+                bulkInsert( batch.book->sells, batch.sells );
+            }
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for( unsigned worker = 1; worker < threads; ++worker ) {
+        workers.push_back( std::async( std::launch::async, work, worker ) );
+    }
+    if( threads > 0 ) work( 0 );
+    for(auto& w: workers ) w.get();
+
+    return errors;
+}
+
 ex::type::ErrorCode ex::OrderBook::notify(const ex::msg::AmendOrder& obj)
 {
-    auto productIdIter = orderIdToProductIdMap.find( obj.orderId );
-    if( productIdIter == orderIdToProductIdMap.end() ) {
+    auto entryIter = orderIndex.find( obj.orderId );
+    if( entryIter == orderIndex.end() ) {
         return ex::type::ErrorCode::InvalidProductId;
     }
 
-    ex::type::ErrorCode err = ex::type::ErrorCode::Ok;
+    auto& entry = entryIter->second;
+    if( entry.side != obj.side || !entry.location.isValid() ) {
+        return ex::type::ErrorCode::InvalidOrderId;
+    }
 
+    auto& book = books[entry.productId];
     if( obj.side == ex::type::Side::Buy ) {
-        err = amend( buys[productIdIter->second], obj );
+        return amend( book.buys, entry, obj );
     } else {
-        err = amend( sells[productIdIter->second], obj );
+        return amend( book.sells, entry, obj );
     }
-
-    return err;
 }
 
 ex::type::ErrorCode ex::OrderBook::notify(const ex::msg::CancelOrder& obj)
 {
-    auto productIdIter = orderIdToProductIdMap.find( obj.orderId );
-    if( productIdIter == orderIdToProductIdMap.end() ) {
+    auto entryIter = orderIndex.find( obj.orderId );
+    if( entryIter == orderIndex.end() ) {
         return ex::type::ErrorCode::InvalidProductId;
     }
 
-    ex::type::ErrorCode err = ex::type::ErrorCode::Ok;
+    auto& entry = entryIter->second;
+    if( entry.side != obj.side || !entry.location.isValid() ) {
+        return ex::type::ErrorCode::InvalidOrderId;
+    }
 
+    auto& book = books[entry.productId];
     if( obj.side == ex::type::Side::Buy ) {
-        err = cancel( buys[productIdIter->second], obj );
+        return cancel( book.buys, entry );
     } else {
-        err = cancel( sells[productIdIter->second], obj );
+        return cancel( book.sells, entry );
     }
-
-    return err;
 }
 
 ex::type::ErrorCode ex::OrderBook::notify(const ex::msg::Trade& obj)
 {
-    return execute( buys[obj.productId], sells[obj.productId], obj);
+    auto& book = books[obj.productId];
+    return execute( book.buys, book.sells, obj );
 }
@@ -0,0 +1,41 @@
+#include "ex/mem/CountingAllocator.h"
+#include <sstream>
+
+namespace ex{ namespace mem{
+    std::ostream& operator<<(std::ostream& out, Subsystem s)
+    {
+        switch(s) {
+            case Subsystem::BookNodes:
+                out << "Book nodes"; break;
+            case Subsystem::OrderIndex:
+                out << "Order index"; break;
+            case Subsystem::ProductMaps:
+                out << "Product maps"; break;
+            case Subsystem::ErrorStorage:
+                out << "Error storage"; break;
+            default:
+                out << "Unknown"; break;
+        }
+        return out;
+    }
+
+    void printAllocationStats(std::ostream& out)
+    {
+        out << std::setw(16) << std::left << "Subsystem"
+            << std::setw(14) << "Allocs"
+            << std::setw(14) << "Frees"
+            << std::setw(14) << "Bytes"
+            << std::setw(14) << "PeakBytes" << std::endl;
+        for( std::size_t s = 0; s < static_cast<std::size_t>(Subsystem::Count); ++s ) {
+            auto subsystem = static_cast<Subsystem>(s);
+            auto& stats = statsOf( subsystem );
+            std::ostringstream name;
+            name << subsystem;
+            out << std::setw(16) << std::left << name.str()
+                << std::setw(14) << stats.allocations.load( std::memory_order_relaxed )
+                << std::setw(14) << stats.deallocations.load( std::memory_order_relaxed )
+                << std::setw(14) << stats.currentBytes.load( std::memory_order_relaxed )
+                << std::setw(14) << stats.peakBytes.load( std::memory_order_relaxed ) << std::endl;
+        }
+    }
+}}
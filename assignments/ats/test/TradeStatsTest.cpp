@@ -0,0 +1,142 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+#include "ex/OrderBook.h"
+
+namespace {
+    ex::msg::NewOrder newOrder(ex::type::OrderId id, ex::type::Side side, ex::type::Quantity qty, ex::type::Price price) {
+        ex::msg::NewOrder obj;
+        obj.productId = 5;
+        obj.orderId = id;
+        obj.side = side;
+        obj.quantity = qty;
+        obj.price = price;
+        return obj;
+    }
+
+    ex::msg::Trade trade(ex::type::Quantity qty, ex::type::Price price) {
+        ex::msg::Trade obj;
+        obj.productId = 5;
+        obj.quantity = qty;
+        obj.price = price;
+        return obj;
+    }
+
+    bool near(double lhs, double rhs) { return std::fabs( lhs - rhs ) < 1e-9 * std::fabs( rhs ); }
+}
+
+// Test Program: trades executed by the book feed the trade statistics,
+//  rejected ones do not; VWAP, volume and OHLC bars by count and by feed
+//  time; the window VWAP stays exact over a long session
+int main() {
+    using ex::type::Side;
+    using ex::type::ErrorCode;
+    using std::chrono::nanoseconds;
+    using std::chrono::seconds;
+
+    {
+        ex::OrderBook book;
+        ex::state::TradeStats::Config config;
+        config.tradesPerBar = 3;
+        if( !book.setTradeStatsConfig( config ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        book.notify( newOrder( 1, Side::Buy, 10, 100.1 ) );
+        book.notify( newOrder( 2, Side::Sell, 10, 100.1 ) );
+        book.notify( newOrder( 3, Side::Buy, 10, 100.3 ) );
+        book.notify( newOrder( 4, Side::Sell, 10, 100.3 ) );
+        book.notify( newOrder( 5, Side::Sell, 10, 100.7 ) );
+
+        // No bid at 100.7, no offer at 99
+        if( book.notify( trade( 5, 100.7 ) ) != ErrorCode::TradeWithNoValidBuySide
+            || book.notify( trade( 5, 99 ) ) != ErrorCode::TradeWithNoValidBuySide
+            || book.getTradeStats( 5 ).tradeCount() != 0 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+
+        if( book.notify( trade( 2, 100.1 ) ) != ErrorCode::Ok
+            || book.notify( trade( 3, 100.3 ) ) != ErrorCode::Ok
+            || book.notify( trade( 5, 100.1 ) ) != ErrorCode::Ok
+            || book.notify( trade( 1, 100.3 ) ) != ErrorCode::Ok ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        const auto& stats = book.getTradeStats( 5 );
+        double vwap = ( 2 * 100.1 + 3 * 100.3 + 5 * 100.1 + 1 * 100.3 ) / 11;
+        if( stats.tradeCount() != 4 || stats.totalVolume() != 11 || stats.windowVolume() != 11
+            || !near( stats.vwap(), vwap ) || !near( stats.windowVwap(), vwap ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        // One bar of the first 3 trades, the 4th is in the open bar
+        const auto& bars = stats.completedBars();
+        if( bars.size() != 1 || bars[0].open != 100.1 || bars[0].high != 100.3 || bars[0].low != 100.1
+            || bars[0].close != 100.1 || bars[0].volume != 10 || bars[0].tradeCount != 3 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        if( !stats.hasOpenBar() || stats.currentBar().open != 100.3 || stats.currentBar().volume != 1 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    // A config closing a bar on every trade without saying so is rejected
+    {
+        ex::OrderBook book;
+        ex::state::TradeStats::Config config;
+        config.tradesPerBar = 0;
+        if( book.setTradeStatsConfig( config ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    // Time bars close on the feed time given with the trades
+    {
+        ex::state::TradeStats::Config config;
+        config.barInterval = seconds( 60 );
+        ex::state::TradeStats stats( config );
+        stats.notify( 10.0, 1, seconds( 0 ) );
+        stats.notify( 12.0, 1, seconds( 30 ) );
+        stats.notify( 9.0, 1, seconds( 59 ) );
+        if( stats.completedBars().size() != 0 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        stats.notify( 11.0, 2, seconds( 60 ) );
+        const auto& bar = stats.completedBars()[0];
+        if( stats.completedBars().size() != 1 || bar.open != 10.0 || bar.high != 12.0 || bar.low != 9.0
+            || bar.close != 9.0 || bar.volume != 3 || bar.startedAt != seconds( 0 )
+            || stats.currentBar().startedAt != seconds( 60 ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    // After a million trades the window VWAP is that of the last WindowSize
+    //  trades, however large the trades which went through the window
+    //  before them
+    {
+        ex::state::TradeStats stats;
+        const int trades = 1000000, last = trades - static_cast<int>( ex::state::TradeStats::WindowSize );
+        auto price = [&](int i) { return i < last && i % 2 ? 1e7 + i * 0.37 : 0.013 * ( 1 + i % 7 ); };
+        for(int i = 0; i < trades; ++i ) stats.notify( price( i ), 1 + i % 13, nanoseconds( i ) );
+
+        double notional = 0.0, volume = 0.0;
+        for(int i = last; i < trades; ++i ) {
+            notional += price( i ) * ( 1 + i % 13 );
+            volume += 1 + i % 13;
+        }
+        if( stats.windowVolume() != volume || !near( stats.windowVwap(), notional / volume ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << "All TradeStats tests passed" << std::endl;
+    return 0;
+}
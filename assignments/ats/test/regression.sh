@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+#
+# Correctness and performance regression gate for feed_handler.
+#
+#  1. Replays every sample file in data/ through feed_handler and compares
+#     the output with test/golden/<file>.out
+#  2. Replays generated feeds through feed_handler and compares a checksum
+#     of the output with test/golden/generated_<messages>_<seed>_<products>.cksum
+#  3. Replays a generated feed through feed_replay and fails if throughput
+#     or latency percentiles regress beyond the tolerance against this
+#     host's baseline, test/perf/baseline.<host>.txt (not tracked). The
+#     first run on a host records the baseline.
+#
+# The golden files are the output of the baseline commit's feed_handler,
+#  so that the gate compares every later build with the behaviour before
+#  any optimisation. Compared output is normalised:
+#   * the memory summary is dropped, as it is expected to change with
+#     every optimisation
+#   * the error report is reduced to the number of errors: the baseline
+#     listed every rejected message, later builds print a count matrix
+#     and a sample of the messages
+#  Generated feeds leave out trades, which the baseline book applies to a
+#  side it then reports as missing; the sample files do cover trades.
+#
+# Usage: test/regression.sh <bin dir> [--update | --golden <baseline bin dir>]
+#   --update  rewrites this host's performance baseline
+#   --golden  rewrites the golden files with the given feed_handler, which
+#             must be built from the baseline commit (see make update-golden)
+#
+# Environment:
+#   THROUGHPUT_TOLERANCE  allowed drop in throughput, as a fraction (default 0.25)
+#   LATENCY_TOLERANCE     allowed rise in p50/p99 latency, as a fraction (default 1.0)
+#   PERF_RUNS             best of this many replays is compared (default 3)
+
+set -u
+
+BIN=${1:?"[USAGE]: regression.sh <bin dir> [--update | --golden <baseline bin dir>]"}
+UPDATE=0
+GOLDEN_BIN=""
+case "${2:-}" in
+    --update) UPDATE=1 ;;
+    --golden) GOLDEN_BIN=${3:?"--golden needs the bin dir of the baseline build"} ;;
+esac
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+GOLDEN=$ROOT/test/golden
+BASELINE=$ROOT/test/perf/baseline.$(uname -n).txt
+THROUGHPUT_TOLERANCE=${THROUGHPUT_TOLERANCE:-0.25}
+LATENCY_TOLERANCE=${LATENCY_TOLERANCE:-1.0}
+PERF_RUNS=${PERF_RUNS:-3}
+
+# <messages> <seed> <products>
+GENERATED_FEEDS=("200000 1 8" "50000 7 1")
+PERF_FEED="200000 1 8"
+PERF_LOOPS=3
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILURES=0
+
+fail() {
+    echo "FAIL: $*"
+    FAILURES=$((FAILURES + 1))
+}
+
+# Output of feed_handler, normalised as described above
+replay() {
+    "$1/feed_handler" "$2" | awk '
+        /^Memory Summary during exit/ { exit }
+        / occuerred while processing / { ++listed; next }
+        /^Error   / { report = 1; next }
+        report && / errors in [0-9]+ messages$/ { errors = $1; report = 0; next }
+        report { next }
+        { print }
+        END { print "errors: " ( errors == "" ? listed + 0 : errors ) }'
+}
+
+generate() {
+    local name=$1; shift
+    "$BIN/feed_gen" "$@" > "$WORK/$name.txt"
+    echo "$WORK/$name.txt"
+}
+
+echo "== Golden output: sample files"
+for feed in "$ROOT"/data/*.txt; do
+    name=$(basename "$feed" .txt)
+    if [ -n "$GOLDEN_BIN" ]; then
+        replay "$GOLDEN_BIN" "$feed" > "$GOLDEN/$name.out"
+        echo "updated $name"
+        continue
+    fi
+    replay "$BIN" "$feed" > "$WORK/$name.out"
+    if diff -u "$GOLDEN/$name.out" "$WORK/$name.out" > "$WORK/$name.diff"; then
+        echo "ok   $name"
+    else
+        head -40 "$WORK/$name.diff"
+        fail "$name differs from golden output"
+    fi
+done
+
+echo "== Golden output: generated feeds"
+for spec in "${GENERATED_FEEDS[@]}"; do
+    name="generated_${spec// /_}"
+    feed=$(generate "$name" $spec)
+    grep -v '^X,' "$feed" > "$WORK/$name.no_trades.txt"
+    if [ -n "$GOLDEN_BIN" ]; then
+        replay "$GOLDEN_BIN" "$WORK/$name.no_trades.txt" | cksum > "$GOLDEN/$name.cksum"
+        echo "updated $name"
+        continue
+    fi
+    sum=$(replay "$BIN" "$WORK/$name.no_trades.txt" | cksum)
+    if [ "$sum" = "$(cat "$GOLDEN/$name.cksum")" ]; then
+        echo "ok   $name"
+    else
+        fail "$name checksum $sum differs from golden $(cat "$GOLDEN/$name.cksum")"
+    fi
+done
+
+[ -n "$GOLDEN_BIN" ] && exit 0
+
+echo "== Performance: feed_replay on generated feed ($PERF_FEED, $PERF_LOOPS loops, best of $PERF_RUNS)"
+feed=$(generate perf $PERF_FEED)
+best_rate=0; best_p50=0; best_p99=0
+for run in $(seq "$PERF_RUNS"); do
+    # TargetRate Achieved Msgs p50 p90 p99 p99.9 max
+    read -r _ rate _ p50 _ p99 _ <<< "$("$BIN/feed_replay" "$feed" --loops $PERF_LOOPS | sed -n 2p)"
+    echo "run $run: $rate msgs/sec, p50 ${p50}ns, p99 ${p99}ns"
+    [ "$rate" -gt "$best_rate" ] && best_rate=$rate
+    { [ "$best_p50" -eq 0 ] || [ "$p50" -lt "$best_p50" ]; } && best_p50=$p50
+    { [ "$best_p99" -eq 0 ] || [ "$p99" -lt "$best_p99" ]; } && best_p99=$p99
+done
+
+if [ $UPDATE -eq 1 ] || [ ! -f "$BASELINE" ]; then
+    mkdir -p "$(dirname "$BASELINE")"
+    printf "throughput %s\np50 %s\np99 %s\n" "$best_rate" "$best_p50" "$best_p99" > "$BASELINE"
+    echo "recorded baseline for $(uname -n)"
+else
+    base_rate=$(awk '$1 == "throughput" { print $2 }' "$BASELINE")
+    base_p50=$(awk '$1 == "p50" { print $2 }' "$BASELINE")
+    base_p99=$(awk '$1 == "p99" { print $2 }' "$BASELINE")
+    echo "baseline: $base_rate msgs/sec, p50 ${base_p50}ns, p99 ${base_p99}ns"
+
+    awk -v v="$best_rate" -v b="$base_rate" -v t="$THROUGHPUT_TOLERANCE" 'BEGIN { exit !(v >= b * (1 - t)) }' \
+        || fail "throughput $best_rate below baseline $base_rate (tolerance $THROUGHPUT_TOLERANCE)"
+    awk -v v="$best_p50" -v b="$base_p50" -v t="$LATENCY_TOLERANCE" 'BEGIN { exit !(v <= b * (1 + t)) }' \
+        || fail "p50 ${best_p50}ns above baseline ${base_p50}ns (tolerance $LATENCY_TOLERANCE)"
+    awk -v v="$best_p99" -v b="$base_p99" -v t="$LATENCY_TOLERANCE" 'BEGIN { exit !(v <= b * (1 + t)) }' \
+        || fail "p99 ${best_p99}ns above baseline ${base_p99}ns (tolerance $LATENCY_TOLERANCE)"
+fi
+
+if [ $FAILURES -ne 0 ]; then
+    echo "$FAILURES check(s) failed"
+    exit 1
+fi
+echo "All checks passed"
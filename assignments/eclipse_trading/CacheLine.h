@@ -0,0 +1,25 @@
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+#include <cstddef>
+#include <utility>
+
+// Cache line size of the x86-64 and ARMv8 parts this code targets.
+//  Padding is spelled out with char arrays rather than alignas, which
+//  C++11 operator new does not honour for objects on the heap.
+constexpr std::size_t CacheLineSize = 64;
+
+// A T on cache lines of its own: nothing declared around it in the
+//  enclosing object shares a line with it, so that writing it does not
+//  invalidate the lines of its neighbours (false sharing)
+template<typename T>
+struct CacheLinePadded {
+    template<typename... Args>
+    explicit CacheLinePadded(Args&&... args) : value( std::forward<Args>( args )... ) {}
+
+    char padBefore[CacheLineSize];
+    T value;
+    char padAfter[CacheLineSize - sizeof(T) % CacheLineSize];
+};
+
+#endif // CACHE_LINE_H
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "Clocks.h"
+
+template<typename Clock>
+std::int64_t nanosSinceEpoch() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now().time_since_epoch() ).count();
+}
+
+// Keeps the reads of readCost from being optimised away
+volatile std::int64_t readSink;
+
+// Average cost of a Clock::now() call, in nanoseconds
+template<typename Clock>
+double readCost(int reads) {
+    std::int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < reads; ++i ) sum += Clock::now().time_since_epoch().count();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    readSink = sum;
+    return elapsed.count() / reads;
+}
+
+// Test Program: the clocks agree with steady_clock, never go back, and
+//  their read costs are compared
+int main() {
+    TscClock::calibrate();
+
+    // Re-anchored every 20ms for 2s, the TSC time stays within 100us of
+    //  steady_clock, and does not go back across a re-anchor
+    {
+        const auto interval = std::chrono::milliseconds(20);
+        std::int64_t worst = 0;
+        for(int i = 0; i < 100; ++i ) {
+            std::this_thread::sleep_for( interval );
+            std::int64_t steady = nanosSinceEpoch<std::chrono::steady_clock>();
+            std::int64_t before = nanosSinceEpoch<TscClock>();
+            TscClock::reanchor( interval );
+            std::int64_t after = nanosSinceEpoch<TscClock>();
+            std::int64_t error = before > steady ? before - steady : steady - before;
+            if( error > 100000 || after < before ) {
+                std::cout << "Test Case Failed at " << __LINE__ << " due to " << before - steady << "ns" << std::endl;
+                return -1;
+            }
+            if( error > worst ) worst = error;
+        }
+        std::cout << "TscClock: within " << worst << "ns of steady_clock over 2s" << std::endl;
+    }
+
+    std::int64_t last = nanosSinceEpoch<TscClock>();
+    for(int i = 0; i < 1000000; ++i ) {
+        std::int64_t now = nanosSinceEpoch<TscClock>();
+        if( now < last ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        last = now;
+    }
+
+    {
+        // The coarse clock moves along while its updater runs, lagging by
+        //  about the resolution, and stands still after
+        CoarseClock::Updater updater( std::chrono::microseconds(200) );
+        std::int64_t before = nanosSinceEpoch<CoarseClock>();
+        std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+        std::int64_t steady = nanosSinceEpoch<std::chrono::steady_clock>();
+        std::int64_t after = nanosSinceEpoch<CoarseClock>();
+        if( after - before < 10000000 || steady - after > 5000000 || after > steady ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+    std::int64_t stopped = nanosSinceEpoch<CoarseClock>();
+    std::this_thread::sleep_for( std::chrono::milliseconds(2) );
+    if( nanosSinceEpoch<CoarseClock>() != stopped ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    ManualClock::set( ManualClock::time_point( std::chrono::seconds(3) ) );
+    ManualClock::advance( std::chrono::milliseconds(5) );
+    if( nanosSinceEpoch<ManualClock>() != 3005000000LL ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    const int reads = 10000000;
+    std::cout << "system_clock: " << readCost<std::chrono::system_clock>( reads ) << " ns/read" << std::endl;
+    std::cout << "steady_clock: " << readCost<std::chrono::steady_clock>( reads ) << " ns/read" << std::endl;
+    std::cout << "TscClock: " << readCost<TscClock>( reads ) << " ns/read" << std::endl;
+    std::cout << "CoarseClock: " << readCost<CoarseClock>( reads ) << " ns/read" << std::endl;
+    return 0;
+}
@@ -0,0 +1,218 @@
+#ifndef CLOCKS_H
+#define CLOCKS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "SeqLock.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CLOCKS_HAVE_TSC 1
+#endif
+
+// Clocks meeting the std::chrono Clock requirements, to be plugged in
+//  wherever a Clock template parameter is taken (Throttle,
+//  BasicRequestRateTracker). All of them are monotonic and count
+//  nanoseconds from the steady_clock epoch. CoarseClock and ManualClock
+//  time points compare with steady_clock's as they are; TscClock's only
+//  do while it is re-anchored, see below.
+
+// TscClock reads the CPU's time stamp counter and scales it with an
+//  anchor taken against steady_clock. The first use calibrates over 50ms.
+//  A calibration error of a few parts per million makes the TSC time drift
+//  away from steady_clock by that many microseconds per second, so
+//  reanchor() has to be called periodically (a CoarseClock::Updater does
+//  so every reanchorInterval()). Each re-anchor measures the rate over the
+//  whole time since the first calibration and slews the TSC time back to
+//  steady_clock over the next interval, rather than stepping it, so reads
+//  never go back. A read is an rdtsc, a seqlock load of the anchor and a
+//  multiply, with no system call.
+//  Assumes an invariant TSC, synchronised across cores, as on any
+//  x86-64 server of the last decade. Falls back to steady_clock on other
+//  architectures.
+class TscClock {
+public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    static duration reanchorInterval() { return std::chrono::seconds(1); }
+
+    // TimeComplexity: Theta(1)
+    static time_point now() noexcept {
+#ifdef CLOCKS_HAVE_TSC
+        Anchor a = state().anchor.load();
+        double elapsed = static_cast<double>( __rdtsc() - a.ticks ) * a.nanosPerTick;
+        return time_point( duration( a.nanos + static_cast<rep>( elapsed ) ) );
+#else
+        return time_point( duration( steadyNanos() ) );
+#endif
+    }
+
+    // Forces the calibration, so that the first now() on the hot path does
+    //  not pay for it
+    static void calibrate() {
+#ifdef CLOCKS_HAVE_TSC
+        state();
+#endif
+    }
+
+    // Brings the TSC time back to steady_clock by the end of the next
+    //  'interval', which should be the time until the next call.
+    //  Pre-Condition: called from one thread at a time
+    // TimeComplexity: Theta(1)
+    static void reanchor(duration interval = reanchorInterval()) {
+#ifdef CLOCKS_HAVE_TSC
+        State& s = state();
+        Anchor a = s.anchor.load();
+        std::uint64_t ticks = __rdtsc();
+        rep steady = steadyNanos();
+        rep tsc = a.nanos + static_cast<rep>( static_cast<double>( ticks - a.ticks ) * a.nanosPerTick );
+        double rate = static_cast<double>( steady - s.firstNanos ) / static_cast<double>( ticks - s.firstTicks );
+        double span = static_cast<double>( interval.count() > 0 ? interval.count() : 1 );
+        // The rate which meets steady_clock one interval from now. An error
+        //  larger than the interval is caught up over several intervals.
+        double slewed = ( static_cast<double>( steady - tsc ) + span ) / span * rate;
+        if( slewed < rate / 2 ) slewed = rate / 2;
+        if( slewed > rate * 2 ) slewed = rate * 2;
+        s.anchor.store( Anchor{ ticks, tsc, slewed } );
+#else
+        (void)interval;
+#endif
+    }
+private:
+    static rep steadyNanos() noexcept {
+        return std::chrono::duration_cast<duration>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+#ifdef CLOCKS_HAVE_TSC
+    struct Anchor {
+        std::uint64_t ticks;
+        rep nanos;
+        double nanosPerTick;
+    };
+
+    struct State {
+        std::uint64_t firstTicks;
+        rep firstNanos;
+        SeqLock<Anchor> anchor;
+
+        State() {
+            firstNanos = steadyNanos();
+            firstTicks = __rdtsc();
+            std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+            rep nanos = steadyNanos();
+            std::uint64_t ticks = __rdtsc();
+            anchor.store( Anchor{ ticks, nanos, static_cast<double>( nanos - firstNanos ) / static_cast<double>( ticks - firstTicks ) } );
+        }
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+#endif
+};
+
+// CoarseClock returns a time cached in memory, which an Updater thread
+//  refreshes from steady_clock every 'resolution'. A read is one relaxed
+//  atomic load; the time it returns lags by up to the resolution, and
+//  stands still if no Updater is running. The Updater also re-anchors
+//  TscClock every TscClock::reanchorInterval().
+//    CoarseClock::Updater updater(std::chrono::microseconds(100));
+class CoarseClock {
+public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<CoarseClock>;
+    static constexpr bool is_steady = true;
+
+    // TimeComplexity: Theta(1)
+    static time_point now() noexcept {
+        return time_point( duration( cached().load( std::memory_order_relaxed ) ) );
+    }
+
+    // Refreshes the cached time from steady_clock
+    static void update() noexcept {
+        cached().store( steadyNanos(), std::memory_order_relaxed );
+    }
+
+    // Keeps the cached time fresh for as long as it lives. One is enough
+    //  per process.
+    class Updater {
+    public:
+        explicit Updater(std::chrono::nanoseconds resolution = std::chrono::microseconds(100))
+            : running(true)
+        {
+            update();
+            thread = std::thread( [this, resolution]() {
+                auto reanchorAt = std::chrono::steady_clock::now() + TscClock::reanchorInterval();
+                while( running.load( std::memory_order_relaxed ) ) {
+                    std::this_thread::sleep_for( resolution );
+                    update();
+                    if( std::chrono::steady_clock::now() >= reanchorAt ) {
+                        TscClock::reanchor();
+                        reanchorAt += TscClock::reanchorInterval();
+                    }
+                }
+            });
+        }
+
+        ~Updater() {
+            running.store( false, std::memory_order_relaxed );
+            thread.join();
+        }
+
+        Updater(const Updater&) = delete;
+        Updater& operator=(const Updater&) = delete;
+    private:
+        std::atomic<bool> running;
+        std::thread thread;
+    };
+private:
+    static rep steadyNanos() noexcept {
+        return std::chrono::duration_cast<duration>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    static std::atomic<rep>& cached() noexcept {
+        static std::atomic<rep> value( steadyNanos() );
+        return value;
+    }
+};
+
+// ManualClock only moves when told to, for deterministic tests of code
+//  templated on a Clock. The time is process-wide, as Clock::now() is
+//  static.
+class ManualClock {
+public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::time_point<ManualClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        return time_point( duration( current().load( std::memory_order_relaxed ) ) );
+    }
+
+    static void set(time_point time) noexcept {
+        current().store( time.time_since_epoch().count(), std::memory_order_relaxed );
+    }
+
+    static void advance(duration d) noexcept {
+        current().fetch_add( d.count(), std::memory_order_relaxed );
+    }
+private:
+    static std::atomic<rep>& current() noexcept {
+        static std::atomic<rep> value( 0 );
+        return value;
+    }
+};
+
+#endif // CLOCKS_H
@@ -0,0 +1,186 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "KeyedThrottle.h"
+
+using Nanos = KeyedThrottle::Nanos;
+
+const Nanos Millis = 1000000;
+const Nanos Hour = 3600LL * 1000 * Millis;
+
+// GCRA over an unordered_map which never forgets a key, as the reference
+//  for the table and its evictions
+struct ReferenceThrottle {
+    Nanos emission, tolerance;
+    std::unordered_map<KeyedThrottle::Key, Nanos> tat;
+
+    ReferenceThrottle(std::size_t limit, Nanos interval, std::size_t burst)
+        : emission( ( interval + static_cast<Nanos>( limit - burst + 1 ) - 1 ) / static_cast<Nanos>( limit - burst + 1 ) )
+        , tolerance( emission * static_cast<Nanos>( burst - 1 ) )
+    {}
+
+    bool tryAcquire(KeyedThrottle::Key key, Nanos now) {
+        auto it = tat.find( key );
+        Nanos t = it == tat.end() ? now : it->second;
+        if( now < t - tolerance ) return false;
+        tat[key] = ( t > now ? t : now ) + emission;
+        return true;
+    }
+};
+
+// Test Program
+int main(int argc, char* argv[]) {
+    {
+        // 3 requests per 100ms, all 3 back to back: then one more per 100ms
+        KeyedThrottle kt( 3, std::chrono::milliseconds(100), 3 );
+        for(int i = 0; i < 3; ++i ) {
+            if( !kt.isWithinLimit( 7, 0 ) || !kt.tryAcquire( 7, 0 ) ) {
+                std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+                return -1;
+            }
+        }
+        if( kt.isWithinLimit( 7, 0 ) || kt.tryAcquire( 7, 0 ) || std::fabs( kt.waitFor( 7, 0 ) - 0.1 ) > 1e-9 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        // Other keys are not affected
+        if( !kt.isWithinLimit( 8, 0 ) || kt.waitFor( 8, 0 ) != 0.0 || !kt.tryAcquire( 8, 0 ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        kt.advance( 30 * Millis );
+        if( kt.size() != 2 || kt.tryAcquire( 7, 67 * Millis ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        // Idle keys are evicted once they are back at their full burst
+        if( !kt.tryAcquire( 7, 100 * Millis ) || kt.tryAcquire( 7, 100 * Millis ) || kt.size() != 1 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        kt.advance( 500 * Millis );
+        if( kt.size() != 0 || kt.memoryUsage().scheduledExpiries != 0 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        for(int i = 0; i < 3; ++i ) {
+            if( !kt.tryAcquire( 7, 500 * Millis ) ) {
+                std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+                return -1;
+            }
+        }
+        if( kt.tryAcquire( 7, 500 * Millis ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    {
+        // 3 requests per 100ms without a burst: one every 33.3ms
+        KeyedThrottle kt( 3, std::chrono::milliseconds(100) );
+        if( !kt.tryAcquire( 7, 0 ) || kt.tryAcquire( 7, 0 ) || std::fabs( kt.waitFor( 7, 0 ) - 0.0333333 ) > 1e-6
+            || kt.tryAcquire( 7, 33 * Millis ) || !kt.tryAcquire( 7, 34 * Millis ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    {
+        // Whatever the burst, every window of 'interval' holds at most
+        //  'limit' of the requests admitted for a key
+        const std::size_t limit = 5;
+        const Nanos interval = 50 * Millis;
+        for( std::size_t burst = 1; burst <= limit; ++burst ) {
+            KeyedThrottle kt( limit, std::chrono::nanoseconds( interval ), burst );
+            std::mt19937_64 gen( burst );
+            std::vector<Nanos> times;
+            Nanos now = 0;
+            for(int i = 0; i < 100000; ++i ) {
+                now += static_cast<Nanos>( gen() % ( 2 * Millis ) );
+                if( i % 1000 == 0 ) now += static_cast<Nanos>( gen() % ( 2 * interval ) );
+                if( kt.tryAcquire( 1, now ) ) times.push_back( now );
+            }
+            for( std::size_t i = 0; i + limit < times.size(); ++i ) {
+                if( times[i + limit] - times[i] < interval ) {
+                    std::cout << "Test Case Failed at " << __LINE__ << " for burst " << burst << std::endl;
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Limits longer than the wheel reaches: the key stays until its TAT
+        KeyedThrottle kt( 1, std::chrono::hours(10) );
+        kt.notify( 1, 0 );
+        kt.advance( 9 * Hour );
+        if( kt.size() != 1 || kt.isWithinLimit( 1, 9 * Hour ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        kt.advance( 10 * Hour + Millis );
+        if( kt.size() != 0 || !kt.isWithinLimit( 1, 10 * Hour + Millis ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    {
+        // No requests at all
+        KeyedThrottle kt( 0, std::chrono::seconds(1) );
+        if( kt.isWithinLimit( 1, 0 ) || kt.tryAcquire( 1, 0 ) || !std::isinf( kt.waitFor( 1, 0 ) ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    {
+        // Random traffic over many keys against the reference, with the
+        //  evictions going on underneath
+        const std::size_t limit = 5;
+        KeyedThrottle kt( limit, std::chrono::milliseconds(50), 2, 64, std::chrono::microseconds(250) );
+        ReferenceThrottle ref( limit, 50 * Millis, 2 );
+        std::mt19937_64 gen( 42 );
+        Nanos now = 0;
+        for(int i = 0; i < 1000000; ++i ) {
+            now += static_cast<Nanos>( gen() % 20000 );
+            if( i % 100000 == 0 ) now += Hour;
+            KeyedThrottle::Key key = gen() % ( i < 500000 ? 20000 : 300 );
+            bool within = kt.isWithinLimit( key, now );
+            if( within != kt.tryAcquire( key, now ) || within != ref.tryAcquire( key, now ) ) {
+                std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+                return -1;
+            }
+        }
+        if( kt.size() > 300 + 20000 / 100 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    // Throughput over a live key set of the given size
+    std::size_t keys = argc > 1 ? std::stoul( argv[1] ) : 50000;
+    const int requests = 20000000;
+    KeyedThrottle kt( 100, std::chrono::seconds(1), 10, keys );
+    std::mt19937_64 gen( 7 );
+    std::vector<KeyedThrottle::Key> trace( 1 << 20 );
+    for(auto& k: trace ) k = gen() % keys;
+
+    long allowed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < requests; ++i ) {
+        // 10M requests per simulated second
+        allowed += kt.tryAcquire( trace[i & ( trace.size() - 1 )], static_cast<Nanos>( i ) * 100 );
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    auto usage = kt.memoryUsage();
+    std::cout << keys << " keys: " << static_cast<long long>( requests / elapsed.count() ) << " requests/s, "
+              << allowed << " allowed, " << usage.keys << " live keys in " << usage.bytes << " bytes" << std::endl;
+    return 0;
+}
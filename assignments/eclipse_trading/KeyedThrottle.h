@@ -0,0 +1,281 @@
+#ifndef KEYED_THROTTLE_H
+#define KEYED_THROTTLE_H
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// KeyedThrottle limits requests per key (session, symbol, account, ...),
+//  allowing every key independently at most 'limit' requests in any
+//  window of 'interval', with up to 'burst' of them back to back.
+//  Each key is limited with GCRA (generic cell rate algorithm): all the
+//  state of a key is its theoretical arrival time (TAT), the time at which
+//  the key will have its full burst available again. A request at 'now'
+//  is allowed if now >= TAT - tolerance, and pushes TAT by the emission
+//  interval. The pacing is SharedThrottle's: limit - burst + 1 requests
+//  are spread evenly over the interval, and the burst runs ahead of that
+//  pace by burst - 1 of them.
+//  Keys live in a pool of 24 byte entries, found through an
+//  open-addressing index of 32-bit entry numbers that is kept at most half
+//  full, so a key costs 32 to 40 bytes plus the pool's spare capacity.
+//  A key whose TAT has passed is indistinguishable from a new key, so it
+//  is evicted; expiries are driven by a hierarchical timing wheel whose
+//  slots are lists linked through the entries themselves.
+//  Times are nanoseconds on a monotonic clock, passed in by the caller.
+class KeyedThrottle {
+public:
+    using Key = std::uint64_t;
+    using Nanos = std::int64_t;
+
+    // Pre-Condition: 1 <= burst <= limit, unless limit is 0
+    KeyedThrottle(
+        std::size_t limit,
+        std::chrono::nanoseconds interval,
+        std::size_t burst = 1,
+        std::size_t expectedKeys = 1024,
+        std::chrono::nanoseconds tick = std::chrono::milliseconds(1)
+    ) : emission( limit == 0 ? 0 : divideUp( interval.count(), static_cast<Nanos>( limit - burst + 1 ) ) )
+      , tolerance( limit == 0 ? 0 : emission * static_cast<Nanos>( burst - 1 ) )
+      , tickSize( tick.count() > 0 ? tick.count() : 1 )
+      , blocked( limit == 0 )
+    {
+        std::size_t slots = 16;
+        while( slots < expectedKeys * 2 ) slots <<= 1;
+        index.assign( slots, std::uint32_t( Nil ) );
+        entries.reserve( expectedKeys );
+        for(auto& level: wheel ) level.fill( std::uint32_t( Nil ) );
+    }
+
+    // TimeComplexity: O(1) - Expected Cost
+    bool isWithinLimit(Key key, Nanos now) const {
+        if( blocked ) return false;
+        const Entry* e = find( key );
+        return e == nullptr || now >= e->tat - tolerance;
+    }
+
+    // Seconds until a request for key would be allowed, 0.0 if right away
+    // TimeComplexity: O(1) - Expected Cost
+    double waitFor(Key key, Nanos now) const {
+        if( blocked ) return std::numeric_limits<double>::infinity();
+        const Entry* e = find( key );
+        Nanos wait = e == nullptr ? 0 : e->tat - tolerance - now;
+        return wait > 0 ? wait * 1e-9 : 0.0;
+    }
+
+    // Records a request for key if it is within the limit
+    // TimeComplexity: O(1) - Amortized Cost
+    bool tryAcquire(Key key, Nanos now) {
+        advance( now );
+        if( blocked ) return false;
+        Entry& e = entries[ findOrInsert( key, now ) ];
+        if( now < e.tat - tolerance ) return false;
+        e.tat = ( e.tat > now ? e.tat : now ) + emission;
+        return true;
+    }
+
+    // Records a request for key whether or not it is within the limit
+    // TimeComplexity: O(1) - Amortized Cost
+    void notify(Key key, Nanos now) {
+        advance( now );
+        Entry& e = entries[ findOrInsert( key, now ) ];
+        e.tat = ( e.tat > now ? e.tat : now ) + emission;
+    }
+
+    // Evicts the keys which have been idle long enough to be back at
+    //  their full burst. Called by tryAcquire and notify as well.
+    // TimeComplexity: O(1) - Amortized Cost per tick and per eviction
+    void advance(Nanos now) {
+        Nanos target = now / tickSize;
+        if( !started ) {
+            currentTick = target;
+            started = true;
+            return;
+        }
+        while( currentTick < target ) {
+            if( scheduled == 0 ) {
+                currentTick = target;
+                break;
+            }
+            // Skip to the end of the lowest wheel when it is empty
+            if( levelCounts[0] == 0 ) {
+                Nanos last = currentTick | ( WheelSlots - 1 );
+                currentTick = last < target ? last : target - 1;
+            }
+            ++currentTick;
+            // Higher levels first, as they cascade into the lower ones
+            std::size_t top = 0;
+            while( top + 1 < Levels && ( currentTick & ( ( Nanos(1) << ( WheelBits * ( top + 1 ) ) ) - 1 ) ) == 0 ) ++top;
+            for( std::size_t level = top; level > 0; --level ) cascade( level );
+            fire();
+        }
+    }
+
+    std::size_t size() const { return count; }
+
+    struct MemoryUsage {
+        std::size_t keys;
+        std::size_t tableSlots;
+        std::size_t scheduledExpiries;
+        std::size_t bytes;
+    };
+
+    MemoryUsage memoryUsage() const {
+        std::size_t bytes = entries.capacity() * sizeof(Entry) + index.size() * sizeof(std::uint32_t) + sizeof(wheel);
+        return MemoryUsage{ count, index.size(), scheduled, bytes };
+    }
+private:
+    // 'next' links the entry into its wheel slot, or into the free list
+    //  once evicted; 'bucket' is its position in the index
+    struct Entry {
+        Key key;
+        Nanos tat;
+        std::uint32_t next;
+        std::uint32_t bucket;
+    };
+
+    static constexpr std::uint32_t Nil = ~std::uint32_t(0);
+    static constexpr std::size_t WheelBits = 6;
+    static constexpr std::size_t WheelSlots = std::size_t(1) << WheelBits;
+    static constexpr std::size_t Levels = 4;
+
+    Nanos emission;     // spacing of the paced requests
+    Nanos tolerance;    // how far ahead of the pace a burst may run
+    Nanos tickSize;
+    bool blocked;
+
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> index;
+    std::uint32_t freeList = Nil;
+    std::size_t count = 0;
+
+    // Every live entry has exactly one pending expiry in the wheel
+    std::array<std::array<std::uint32_t, WheelSlots>, Levels> wheel;
+    std::array<std::size_t, Levels> levelCounts{};
+    std::size_t scheduled = 0;
+    Nanos currentTick = 0;
+    bool started = false;
+
+    static Nanos divideUp(Nanos lhs, Nanos rhs) { return ( lhs + rhs - 1 ) / rhs; }
+
+    std::size_t bucketOf(Key key) const {
+        return static_cast<std::size_t>( ( key * 0x9E3779B97F4A7C15ull ) >> 32 ) & ( index.size() - 1 );
+    }
+
+    const Entry* find(Key key) const {
+        for( std::size_t i = bucketOf( key ); index[i] != Nil; i = ( i + 1 ) & ( index.size() - 1 ) ) {
+            const Entry& e = entries[ index[i] ];
+            if( e.key == key ) return &e;
+        }
+        return nullptr;
+    }
+
+    std::uint32_t findOrInsert(Key key, Nanos now) {
+        std::size_t i = bucketOf( key );
+        for( ; index[i] != Nil; i = ( i + 1 ) & ( index.size() - 1 ) ) {
+            if( entries[ index[i] ].key == key ) return index[i];
+        }
+        if( ( count + 1 ) * 2 > index.size() ) {
+            grow();
+            return findOrInsert( key, now );
+        }
+        std::uint32_t id = freeList;
+        if( id != Nil ) {
+            freeList = entries[id].next;
+        } else {
+            assert( entries.size() < Nil );
+            id = static_cast<std::uint32_t>( entries.size() );
+            entries.push_back( Entry() );
+        }
+        entries[id].key = key;
+        entries[id].tat = now;
+        entries[id].bucket = static_cast<std::uint32_t>( i );
+        index[i] = id;
+        ++count;
+        schedule( id, now + emission );
+        return id;
+    }
+
+    void grow() {
+        std::vector<std::uint32_t> old( index.size() * 2, std::uint32_t( Nil ) );
+        old.swap( index );
+        for(std::uint32_t id: old ) {
+            if( id == Nil ) continue;
+            std::size_t i = bucketOf( entries[id].key );
+            while( index[i] != Nil ) i = ( i + 1 ) & ( index.size() - 1 );
+            index[i] = id;
+            entries[id].bucket = static_cast<std::uint32_t>( i );
+        }
+    }
+
+    // Backward shift deletion from the index, so that lookups never see
+    //  tombstones; the entry goes back to the free list
+    void erase(std::uint32_t id) {
+        std::size_t hole = entries[id].bucket;
+        std::size_t mask = index.size() - 1;
+        for( std::size_t i = ( hole + 1 ) & mask; index[i] != Nil; i = ( i + 1 ) & mask ) {
+            std::size_t home = bucketOf( entries[ index[i] ].key );
+            // Move the entry into the hole unless its home lies in (hole, i]
+            if( ( ( i - home ) & mask ) >= ( ( i - hole ) & mask ) ) {
+                index[hole] = index[i];
+                entries[ index[hole] ].bucket = static_cast<std::uint32_t>( hole );
+                hole = i;
+            }
+        }
+        index[hole] = Nil;
+        entries[id].next = freeList;
+        freeList = id;
+        --count;
+    }
+
+    // Schedules the expiry of entry id for the first tick at or after 'at'
+    void schedule(std::uint32_t id, Nanos at) {
+        Nanos tick = ( at + tickSize - 1 ) / tickSize;
+        if( tick <= currentTick ) tick = currentTick + 1;
+        Nanos delta = tick - currentTick;
+        std::size_t level = 0;
+        while( level + 1 < Levels && delta >= ( Nanos(1) << ( WheelBits * ( level + 1 ) ) ) ) ++level;
+        // Beyond the wheel's reach: park in the last slot reachable, the
+        //  entry is rescheduled when it fires
+        if( delta >= ( Nanos(1) << ( WheelBits * Levels ) ) ) tick = currentTick + ( Nanos(1) << ( WheelBits * Levels ) ) - 1;
+        std::uint32_t& head = wheel[level][ static_cast<std::size_t>( tick >> ( WheelBits * level ) ) & ( WheelSlots - 1 ) ];
+        entries[id].next = head;
+        head = id;
+        ++levelCounts[level];
+        ++scheduled;
+    }
+
+    // Re-files the entries of the current slot of 'level' into lower levels
+    void cascade(std::size_t level) {
+        drain( level, static_cast<std::size_t>( currentTick >> ( WheelBits * level ) ) & ( WheelSlots - 1 ) );
+    }
+
+    // Expires the entries due on the current tick
+    void fire() {
+        drain( 0, static_cast<std::size_t>( currentTick ) & ( WheelSlots - 1 ) );
+    }
+
+    // Evicts every entry of the slot whose TAT has passed, and schedules
+    //  the others for their TAT
+    void drain(std::size_t level, std::size_t slot) {
+        std::uint32_t id = wheel[level][slot];
+        wheel[level][slot] = Nil;
+        Nanos now = currentTick * tickSize;
+        while( id != Nil ) {
+            std::uint32_t next = entries[id].next;
+            --levelCounts[level];
+            --scheduled;
+            if( entries[id].tat <= now ) {
+                erase( id );
+            } else {
+                schedule( id, entries[id].tat );
+            }
+            id = next;
+        }
+    }
+};
+
+#endif // KEYED_THROTTLE_H
@@ -1,9 +1,30 @@
 #ifndef LISTENER_H
 #define LISTENER_H
 
+#include <cstddef>
+#include <type_traits>
+
 class Listener
 {
 public:
+    // A callback captured as a record, for delivering events in batches
+    struct Event {
+        enum class Type : char { Insert, Replace, Ack, Reject, Fill };
+
+        Type type;
+        char side;      // Insert
+        int id;         // oldId for Replace
+        int arg;        // quantity for Insert, newId for Replace, quantityFilled for Fill
+        int delta;      // deltaQuantity for Replace
+        double price;   // Insert
+
+        static Event insert(int id, char side, double price, int quantity) { return Event{ Type::Insert, side, id, quantity, 0, price }; }
+        static Event replace(int oldId, int newId, int deltaQuantity) { return Event{ Type::Replace, 0, oldId, newId, deltaQuantity, 0.0 }; }
+        static Event ack(int id) { return Event{ Type::Ack, 0, id, 0, 0, 0.0 }; }
+        static Event reject(int id) { return Event{ Type::Reject, 0, id, 0, 0, 0.0 }; }
+        static Event fill(int id, int quantityFilled) { return Event{ Type::Fill, 0, id, quantityFilled, 0, 0.0 }; }
+    };
+
     // These two callbacks represent client requests.
     // Indicates the client has sent a new order request to the market. Exactly one
     // callback will follow:
@@ -39,6 +60,56 @@ public:
     virtual void OnOrderFilled(
             int id,
             int quantityFilled) = 0;
+
+    // Delivers 'count' events in order, as if the callbacks had been made
+    //  one by one. Implementations may override this to process a burst
+    //  at once.
+    virtual void OnEvents(
+            const Event* events,
+            std::size_t count) {
+        for( std::size_t i = 0; i < count; ++i ) dispatch( *this, events[i] );
+    }
+
+    // Makes the callback recorded in 'e'
+    template<typename L>
+    static void dispatch(L& listener, const Event& e) {
+        switch( e.type ) {
+            case Event::Type::Insert: listener.OnInsertOrderRequest( e.id, e.side, e.price, e.arg ); break;
+            case Event::Type::Replace: listener.OnReplaceOrderRequest( e.id, e.arg, e.delta ); break;
+            case Event::Type::Ack: listener.OnRequestAcknowledged( e.id ); break;
+            case Event::Type::Reject: listener.OnRequestRejected( e.id ); break;
+            case Event::Type::Fill: listener.OnOrderFilled( e.id, e.arg ); break;
+        }
+    }
+
+    // Makes the callbacks recorded in 'events' on a listener of static type
+    //  L with qualified calls, so that none of them is virtual. L's own
+    //  OnEvents is used if it has one; the inherited one would make a
+    //  virtual call per event.
+    template<typename L>
+    static void dispatchAll(L& listener, const Event* events, std::size_t count) {
+        using Inherited = void (Listener::*)(const Event*, std::size_t);
+        dispatchAll( listener, events, count, std::integral_constant<bool, !std::is_same<decltype(&L::OnEvents), Inherited>::value>() );
+    }
+private:
+    template<typename L>
+    static void dispatchAll(L& listener, const Event* events, std::size_t count, std::true_type) {
+        listener.L::OnEvents( events, count );
+    }
+
+    template<typename L>
+    static void dispatchAll(L& listener, const Event* events, std::size_t count, std::false_type) {
+        for( std::size_t i = 0; i < count; ++i ) {
+            const Event& e = events[i];
+            switch( e.type ) {
+                case Event::Type::Insert: listener.L::OnInsertOrderRequest( e.id, e.side, e.price, e.arg ); break;
+                case Event::Type::Replace: listener.L::OnReplaceOrderRequest( e.id, e.arg, e.delta ); break;
+                case Event::Type::Ack: listener.L::OnRequestAcknowledged( e.id ); break;
+                case Event::Type::Reject: listener.L::OnRequestRejected( e.id ); break;
+                case Event::Type::Fill: listener.L::OnOrderFilled( e.id, e.arg ); break;
+            }
+        }
+    }
 };
 
 #endif // LISTENER_H
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "ListenerBus.h"
+#include "OrderTracker.h"
+#include "RequestRateTracker.h"
+
+// Counts the callbacks it sees, standing in for an audit listener
+struct AuditListener: public Listener {
+    void OnInsertOrderRequest(int, char, double, int) { ++inserts; }
+    void OnReplaceOrderRequest(int, int, int) { ++replaces; }
+    void OnRequestAcknowledged(int) { ++acks; }
+    void OnRequestRejected(int) { ++rejects; }
+    void OnOrderFilled(int, int quantityFilled) { filled += quantityFilled; }
+
+    long inserts = 0, replaces = 0, acks = 0, rejects = 0, filled = 0;
+};
+
+// Keeps the largest order seen, standing in for a risk listener
+struct MaxOrderListener: public Listener {
+    void OnInsertOrderRequest(int, char, double price, int quantity) {
+        if( price * quantity > largest ) largest = price * quantity;
+    }
+    void OnReplaceOrderRequest(int, int, int) {}
+    void OnRequestAcknowledged(int) {}
+    void OnRequestRejected(int) {}
+    void OnOrderFilled(int, int) {}
+
+    double largest = 0.0;
+};
+
+std::vector<Listener::Event> makeEvents(int orders) {
+    std::vector<Listener::Event> events;
+    for(int id = 1; id <= orders * 2; id += 2 ) {
+        events.push_back( Listener::Event::insert(id, id % 4 == 1 ? 'B' : 'O', 10.0 + id % 7, 10) );
+        events.push_back( Listener::Event::ack(id) );
+        events.push_back( Listener::Event::fill(id, 4) );
+        events.push_back( Listener::Event::replace(id, id + 1, 2) );
+        events.push_back( id % 3 ? Listener::Event::ack(id + 1) : Listener::Event::reject(id + 1) );
+        events.push_back( Listener::Event::fill(id % 3 ? id + 1 : id, 6) );
+    }
+    return events;
+}
+
+bool sameAudit(const AuditListener& lhs, const AuditListener& rhs) {
+    return lhs.inserts == rhs.inserts && lhs.replaces == rhs.replaces && lhs.acks == rhs.acks
+        && lhs.rejects == rhs.rejects && lhs.filled == rhs.filled;
+}
+
+template<typename F>
+double callbacksPerSecond(std::size_t callbacks, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return callbacks / elapsed.count();
+}
+
+// Test Program: every way of fanning out must reach every listener with
+//  every callback, followed by a comparison of their dispatch costs
+int main() {
+    auto events = makeEvents( 100000 );
+
+    // Reference: each listener called through the Listener interface
+    OrderTracker ot0; AuditListener audit0; MaxOrderListener risk0;
+    std::vector<Listener*> listeners{ &ot0, &audit0, &risk0 };
+    for(auto& e: events ) {
+        for(auto l: listeners ) Listener::dispatch( *l, e );
+    }
+
+    OrderTracker ot1; AuditListener audit1; MaxOrderListener risk1;
+    ListenerBus<OrderTracker, AuditListener, MaxOrderListener> bus( ot1, audit1, risk1 );
+    for(auto& e: events ) Listener::dispatch( bus, e );
+
+    OrderTracker ot2; AuditListener audit2; MaxOrderListener risk2;
+    ListenerTable table;
+    table.add( ot2 );
+    table.add( audit2 );
+    table.add( risk2 );
+    Listener& asListener = table;
+    for(auto& e: events ) Listener::dispatch( asListener, e );
+
+    OrderTracker ot3; AuditListener audit3; MaxOrderListener risk3;
+    ListenerBus<OrderTracker, AuditListener, MaxOrderListener> batchBus( ot3, audit3, risk3 );
+    batchBus.OnEvents( events.data(), events.size() );
+
+    if( !sameAudit( audit0, audit1 ) || !sameAudit( audit0, audit2 ) || !sameAudit( audit0, audit3 )
+        || risk0.largest != risk1.largest || risk0.largest != risk2.largest || risk0.largest != risk3.largest
+        || ot0.netFilledQuantity() != ot1.netFilledQuantity() || ot0.netFilledQuantity() != ot2.netFilledQuantity()
+        || ot0.netFilledQuantity() != ot3.netFilledQuantity() || ot0.confirmedBidValue() != ot3.confirmedBidValue() ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    // A burst reaches each listener through the same qualified calls as
+    //  single callbacks: an override in a class derived from a listener
+    //  type on the bus or in the table is not called either way
+    {
+        struct DerivedAudit: AuditListener {
+            void OnRequestAcknowledged(int) { ++overridden; }
+            long overridden = 0;
+        };
+        DerivedAudit one, burst, tableBurst;
+        ListenerBus<AuditListener> oneBus( one ), burstBus( burst );
+        ListenerTable burstTable;
+        burstTable.add<AuditListener>( tableBurst );
+        for(auto& e: events ) Listener::dispatch( oneBus, e );
+        burstBus.OnEvents( events.data(), events.size() );
+        burstTable.OnEvents( events.data(), events.size() );
+        if( !sameAudit( one, audit0 ) || !sameAudit( burst, audit0 ) || !sameAudit( tableBurst, audit0 )
+            || one.overridden != 0 || burst.overridden != 0 || tableBurst.overridden != 0 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    RequestRateTracker rrt( 1000000, std::chrono::seconds(1) );
+    ListenerBus<AuditListener, RequestRateTracker> rateBus( audit1, rrt );
+    rateBus.OnInsertOrderRequest( 1, 'B', 10.0, 10 );
+    if( rrt.hasThrottleHit() || audit1.inserts != audit0.inserts + 1 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    // Dispatch cost with light listeners, so that the fan-out dominates
+    const int rounds = 20;
+    AuditListener a[4];
+    MaxOrderListener m[4];
+    std::vector<Listener*> virtualFanout{ &a[0], &m[0], &a[1], &m[1], &a[2], &m[2], &a[3], &m[3] };
+    ListenerBus<AuditListener, MaxOrderListener, AuditListener, MaxOrderListener,
+                AuditListener, MaxOrderListener, AuditListener, MaxOrderListener>
+        staticFanout( a[0], m[0], a[1], m[1], a[2], m[2], a[3], m[3] );
+    ListenerTable tableFanout;
+    for(int i = 0; i < 4; ++i ) { tableFanout.add( a[i] ); tableFanout.add( m[i] ); }
+
+    std::size_t callbacks = events.size() * rounds;
+    std::cout << "8 listeners, virtual calls: " << static_cast<long long>( callbacksPerSecond( callbacks, [&]() {
+        for(int r = 0; r < rounds; ++r ) for(auto& e: events ) for(auto l: virtualFanout ) Listener::dispatch( *l, e );
+    }) ) << " events/s" << std::endl;
+    std::cout << "8 listeners, ListenerBus: " << static_cast<long long>( callbacksPerSecond( callbacks, [&]() {
+        for(int r = 0; r < rounds; ++r ) for(auto& e: events ) Listener::dispatch( staticFanout, e );
+    }) ) << " events/s" << std::endl;
+    std::cout << "8 listeners, ListenerTable: " << static_cast<long long>( callbacksPerSecond( callbacks, [&]() {
+        for(int r = 0; r < rounds; ++r ) for(auto& e: events ) Listener::dispatch( tableFanout, e );
+    }) ) << " events/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#ifndef LISTENER_BUS_H
+#define LISTENER_BUS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Listener.h"
+
+// ListenerBus fans every callback out to a fixed set of listeners, in the
+//  order they are listed. The set is known at compile time, so each
+//  listener is called by its qualified member name: no virtual call is
+//  made and the calls can be inlined, however many listeners are on the
+//  bus. The bus itself is a Listener, for code which only knows that
+//  interface.
+//    OrderTracker ot; RequestRateTracker rrt(10, std::chrono::seconds(1));
+//    ListenerBus<OrderTracker, RequestRateTracker> bus(ot, rrt);
+template<typename... Listeners>
+class ListenerBus;
+
+template<>
+class ListenerBus<>: public Listener {
+public:
+    void OnInsertOrderRequest(int, char, double, int) {}
+    void OnReplaceOrderRequest(int, int, int) {}
+    void OnRequestAcknowledged(int) {}
+    void OnRequestRejected(int) {}
+    void OnOrderFilled(int, int) {}
+    void OnEvents(const Event*, std::size_t) {}
+};
+
+template<typename L, typename... Rest>
+class ListenerBus<L, Rest...>: public ListenerBus<Rest...> {
+    using Next = ListenerBus<Rest...>;
+public:
+    explicit ListenerBus(L& l, Rest&... rest)
+        : Next(rest...)
+        , listener(l)
+    {}
+
+    void OnInsertOrderRequest(int id, char side, double price, int quantity) {
+        listener.L::OnInsertOrderRequest( id, side, price, quantity );
+        Next::OnInsertOrderRequest( id, side, price, quantity );
+    }
+
+    void OnReplaceOrderRequest(int oldId, int newId, int deltaQuantity) {
+        listener.L::OnReplaceOrderRequest( oldId, newId, deltaQuantity );
+        Next::OnReplaceOrderRequest( oldId, newId, deltaQuantity );
+    }
+
+    void OnRequestAcknowledged(int id) {
+        listener.L::OnRequestAcknowledged( id );
+        Next::OnRequestAcknowledged( id );
+    }
+
+    void OnRequestRejected(int id) {
+        listener.L::OnRequestRejected( id );
+        Next::OnRequestRejected( id );
+    }
+
+    void OnOrderFilled(int id, int quantityFilled) {
+        listener.L::OnOrderFilled( id, quantityFilled );
+        Next::OnOrderFilled( id, quantityFilled );
+    }
+
+    // Every listener gets the whole burst in turn, through its own batch
+    //  entry point if it has one and qualified callbacks otherwise
+    void OnEvents(const Listener::Event* events, std::size_t count) {
+        Listener::dispatchAll( listener, events, count );
+        Next::OnEvents( events, count );
+    }
+private:
+    L& listener;
+};
+
+// Fans callbacks out to listeners added at runtime. Each listener is
+//  registered with plain function pointers to thunks which call its
+//  callbacks non-virtually, and the entries are kept in a flat array, so
+//  dispatching is a walk over contiguous memory with one indirect call
+//  per listener.
+class ListenerTable: public Listener {
+public:
+    template<typename L>
+    void add(L& l) {
+        entries.push_back( Entry{
+            &l,
+            &insertThunk<L>,
+            &replaceThunk<L>,
+            &ackThunk<L>,
+            &rejectThunk<L>,
+            &fillThunk<L>,
+            &eventsThunk<L>
+        });
+    }
+
+    std::size_t size() const { return entries.size(); }
+
+    void OnInsertOrderRequest(int id, char side, double price, int quantity) {
+        for(auto& e: entries ) e.insert( e.listener, id, side, price, quantity );
+    }
+
+    void OnReplaceOrderRequest(int oldId, int newId, int deltaQuantity) {
+        for(auto& e: entries ) e.replace( e.listener, oldId, newId, deltaQuantity );
+    }
+
+    void OnRequestAcknowledged(int id) {
+        for(auto& e: entries ) e.ack( e.listener, id );
+    }
+
+    void OnRequestRejected(int id) {
+        for(auto& e: entries ) e.reject( e.listener, id );
+    }
+
+    void OnOrderFilled(int id, int quantityFilled) {
+        for(auto& e: entries ) e.fill( e.listener, id, quantityFilled );
+    }
+
+    void OnEvents(const Event* events, std::size_t count) {
+        for(auto& e: entries ) e.events( e.listener, events, count );
+    }
+private:
+    struct Entry {
+        void* listener;
+        void (*insert)(void*, int, char, double, int);
+        void (*replace)(void*, int, int, int);
+        void (*ack)(void*, int);
+        void (*reject)(void*, int);
+        void (*fill)(void*, int, int);
+        void (*events)(void*, const Event*, std::size_t);
+    };
+
+    std::vector<Entry> entries;
+
+    template<typename L>
+    static void insertThunk(void* l, int id, char side, double price, int quantity) {
+        static_cast<L*>(l)->L::OnInsertOrderRequest( id, side, price, quantity );
+    }
+
+    template<typename L>
+    static void replaceThunk(void* l, int oldId, int newId, int deltaQuantity) {
+        static_cast<L*>(l)->L::OnReplaceOrderRequest( oldId, newId, deltaQuantity );
+    }
+
+    template<typename L>
+    static void ackThunk(void* l, int id) {
+        static_cast<L*>(l)->L::OnRequestAcknowledged( id );
+    }
+
+    template<typename L>
+    static void rejectThunk(void* l, int id) {
+        static_cast<L*>(l)->L::OnRequestRejected( id );
+    }
+
+    template<typename L>
+    static void fillThunk(void* l, int id, int quantityFilled) {
+        static_cast<L*>(l)->L::OnOrderFilled( id, quantityFilled );
+    }
+
+    template<typename L>
+    static void eventsThunk(void* l, const Event* events, std::size_t count) {
+        Listener::dispatchAll( *static_cast<L*>(l), events, count );
+    }
+};
+
+#endif // LISTENER_BUS_H
@@ -1,396 +1,225 @@
-#include <chrono>
-#include <cassert>
-#include <string>
-#include <unordered_map>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
-#include "Listener.h"
+#include "OrderTracker.h"
+#include "PriceLadder.h"
 
-enum class Side : char{
-    Bid = 'B',
-    Offer = 'O'
-};
-
-// OrderInfo is used to hold all parameters associated with an Insert Order Request
-struct OrderInfo {
-    Side side;
-    double price;
-    int quantity;
-
-    OrderInfo() = default;
-    OrderInfo(const OrderInfo&) = default;
-    OrderInfo(OrderInfo&&) = default;
-
-    OrderInfo& operator=(const OrderInfo&) = default;
-    OrderInfo& operator=(OrderInfo&&) = default;
-
-    OrderInfo(char s, double p, int q) 
-        : side( static_cast<Side>(s) )
-        , price( p )
-        , quantity( q )
-    {}
-
-    OrderInfo(Side s, double p, int q) 
-        : side( s )
-        , price( p )
-        , quantity( q)
-    {}
-    
-};
+// An extra metric plugged into the tracker: notional value filled so far
+struct FilledValue: NoOpAccumulator {
+    void notifyFill(const OrderInfo& order, int qtyFilled) {
+        val += order.price * qtyFilled;
+    }
 
-// ReplaceInfo is used to hold all parameters associated with an Insert Order Request
-struct ReplaceInfo {
-    int newId;
-    int deltaQty;
+    double value() const { return val; }
+private:
+    double val = 0.0;
 };
 
-using OrderStore = std::unordered_map<int, OrderInfo>;
-using PendingReplace = std::unordered_map<int, ReplaceInfo>;
-
-
-// A Simple Accumulator class which "Accumulates" Net Filled Quantity.
-//  In order to keep extracting this value efficient, we keep track of 
-//  NFQ known so far. notifyFill does the most of work by re-computing
-//   (and hence accumulating) NFQ.
-struct NetFilledQuantity {
-    NetFilledQuantity(const OrderStore& store)
-        : orderStore(store)
-    {}
-
-    void notifyAck(int id ) {} //No-Op
-    void notifyReject(int id ) {} // No-Op
+// Test Program which tries the test cases provided in the assignment
+int main() {
+    OrderTracker ot;
+    ot.OnInsertOrderRequest(1, 'B', 10.0, 10);
+    std::cout << ot << std::endl;
+    ot.OnRequestAcknowledged(1);
+    std::cout << ot << std::endl;
+    ot.OnInsertOrderRequest(2, 'O', 15.0, 25);
+    std::cout << ot << std::endl;
+    ot.OnRequestAcknowledged(2);
+    std::cout << ot << std::endl;
+    ot.OnOrderFilled(1, 5);
+    std::cout << ot << std::endl;
+    ot.OnOrderFilled(1, 5);
+    std::cout << ot << std::endl;
+    ot.OnReplaceOrderRequest(2, 3, 10);
+    std::cout << ot << std::endl;
+    ot.OnOrderFilled(2, 25);
+    std::cout << ot << std::endl;
+    ot.OnRequestRejected(3);
+    std::cout << ot << std::endl;
 
-    // TimeComplexity: O(1)  - Amortized Cost
-    void notifyFill(int id, int qtyFilled ) {
-        auto iter = orderStore.find( id );
-        assert( iter != orderStore.end() );
+    // Acknowledged replace: order 5 takes over from order 4 with 5 more
+    ot.OnInsertOrderRequest(4, 'B', 20.0, 10);
+    ot.OnRequestAcknowledged(4);
+    ot.OnReplaceOrderRequest(4, 5, 5);
+    std::cout << ot << std::endl;
+    ot.OnRequestAcknowledged(5);
+    std::cout << ot << std::endl;
+    ot.OnOrderFilled(5, 15);
+    std::cout << ot << std::endl;
 
-        auto& orderInfo = iter->second;
-        switch( orderInfo.side ) {
-            case Side::Bid:
-                val += qtyFilled;
-                break;
-            case Side::Offer:
-                val -= qtyFilled;
-                break;
-        }
+    // Terminal orders (rejected, fully filled and replaced) are all gone
+    if( ot.memoryUsage().liveOrders != 0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
 
-    int value() const { return val; } // TimeComplexity: Theta(1)
-private:
-    const OrderStore& orderStore;
-    int val= 0;;
-};
-
-// A Simple Accumulator class which "Accumulates" Confirmed Order Value.
-//  In order to keep extracting this value efficient, we keep track of 
-//  COV for bid and offer sides separately. 
-//  notifyAck and notifyFill does the most of work by re-computing
-//   (and hence accumulating) COV.
-struct ConfirmedOrderValue {
-    ConfirmedOrderValue(const OrderStore& store)
-        : orderStore(store)
-    {}
-   
-    // TimeComplexity: O(1)  - Amortized Cost
-    void notifyAck(int id) {
-        auto iter = orderStore.find( id );
-        assert( iter != orderStore.end() );
-        auto& order = iter->second;
-        switch( order.side ) {
-            case Side::Bid:
-                bid += order.price * order.quantity;
-                break;
-            case Side::Offer:
-                offer += order.price * order.quantity;
-                break;
+    // Memory stays proportional to the open orders: 1000 long lived orders
+    //  fall behind the window while many short lived ones come and go
+    OrderTracker lt(64);
+    const int longLived = 1000;
+    for(int id = 1; id <= 200000; ++id ) {
+        lt.OnInsertOrderRequest(id, id % 2 ? 'B' : 'O', 10.0, 10);
+        if( id % 5 == 0 ) {
+            lt.OnRequestRejected(id);
+            continue;
         }
+        lt.OnRequestAcknowledged(id);
+        if( id % 200 != 1 ) lt.OnOrderFilled(id, 10);
     }
-
-    // TimeComplexity: O(1)  - Amortized Cost
-    void notifyFill(int id, int qtyFilled ) {
-        auto iter = orderStore.find( id );
-        assert( iter != orderStore.end() );
-        auto& order = iter->second;
-        switch( order.side ) {
-            case Side::Bid:
-                bid -= order.price * qtyFilled;
-                break;
-            case Side::Offer:
-                offer -= order.price * qtyFilled;
-                break;
-        }
+    auto usage = lt.memoryUsage();
+    std::cout << "Open orders: " << usage.liveOrders << ", Stragglers: " << usage.stragglers
+              << ", Tracked bytes: " << usage.bytes << std::endl;
+    if( usage.liveOrders != longLived || usage.stragglerSlots > 8 * longLived ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
-
-    double bidValue() const { return bid; } // TimeComplexity: Theta(1)
-    double offerValue() const { return offer; } // TimeComplexity: Theta(1)
-private:
-    const OrderStore& orderStore;
-    double bid = 0.0;
-    double offer = 0.0;
-};
-
-// A Simple Accumulator class which "Accumulates" Pending Order Value.
-//  In order to keep extracting this value efficient, we keep track of 
-//  POV for bid and offer sides separately. Each of side has two values
-//  one for min and another for max.
-//  notifyInsert, notifyAck and notifyFill does the most of work by re-computing
-//   (and hence accumulating) COV.
-struct PendingOrderValue {
-    PendingOrderValue(const OrderStore& store)
-        : orderStore(store)
-    {}
-
-    // TimeComplexity: Theta(1)
-    void notifyInsert(const OrderInfo& order) {
-        switch( order.side ) {
-            case Side::Bid:
-                bidMax += order.price * order.quantity;
-                break;
-            case Side::Offer:
-                offerMax += order.price * order.quantity;
-                break;
-        }
+    for(int id = 1; id <= 200000; id += 200 ) lt.OnOrderFilled(id, 10);
+    usage = lt.memoryUsage();
+    if( usage.liveOrders != 0 || usage.stragglerSlots > 16 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
 
-    // TimeComplexity: O(1)  - Amortized Cost
-    void notifyAck(int id ) {
-        auto iter = orderStore.find( id );
-        assert( iter != orderStore.end() );
-        auto& order = iter->second;
-        switch( order.side ) {
-            case Side::Bid:
-                bidMin += order.price * order.quantity;
-                break;
-            case Side::Offer:
-                offerMin += order.price * order.quantity;
-                break;
+    // Snapshots taken on another thread are never torn: in this feed every
+    //  bid is acknowledged and then fully filled, so confirmed bid value
+    //  and pending bid min always move together
+    OrderTracker st;
+    std::atomic<bool> feeding(true);
+    std::atomic<long> torn(0), snapshots(0);
+    std::thread reader([&]() {
+        while( feeding.load() ) {
+            Exposure e = st.snapshot();
+            if( e.confirmedBidValue != e.pendingBidMinValue ) ++torn;
+            ++snapshots;
         }
+    });
+    for(int id = 1; id <= 200000; ++id ) {
+        int qty = 1 + id % 7;
+        st.OnInsertOrderRequest(id, 'B', 1.0 + id % 13, qty);
+        st.OnRequestAcknowledged(id);
+        st.OnOrderFilled(id, qty);
     }
-
-    // TimeComplexity: Theta(1)
-    void notifyReject(int id ) {} //No-Op
-
-    // TimeComplexity: O(1)  - Amortized Cost
-    void notifyFill(int id, int qtyFilled ) {
-        auto iter = orderStore.find( id );
-        assert( iter != orderStore.end() );
-        auto& order = iter->second;
-        switch( order.side ) {
-            case Side::Bid:
-                bidMin -= order.price * qtyFilled;
-                bidMax -= order.price * qtyFilled;
-                break;
-            case Side::Offer:
-                offerMin -= order.price * qtyFilled;
-                offerMax -= order.price * qtyFilled;
-                break;
-        }
+    feeding.store(false);
+    reader.join();
+    if( torn.load() != 0 || st.snapshot().netFilledQuantity != st.netFilledQuantity() ) {
+        std::cout << "Test Case Failed at " << __LINE__ << " torn snapshots: " << torn.load() << std::endl;
+        return -1;
     }
 
-    double bidMinValue() const { return bidMin; } // TimeComplexity: Theta(1)
-    double bidMaxValue() const { return bidMax; } // TimeComplexity: Theta(1)
-    double offerMinValue() const { return offerMin; } // TimeComplexity: Theta(1)
-    double offerMaxValue() const { return offerMax; } // TimeComplexity: Theta(1)
-private:
-    const OrderStore& orderStore;
-    double bidMin = 0.0;
-    double bidMax = 0.0;
-    double offerMin = 0.0;
-    double offerMax = 0.0;
-};
-
-
-// OrderTracker class implemets the Listener interface and provides functions to fetch
-//  Net Filled Quantity
-//  Confirmed Order Value, and
-//  Pending Order Value
-class OrderTracker: public Listener {
-public:
-    OrderTracker()
-        : orders()
-        , nfq(orders)
-        , cov(orders)
-        , pov(orders)
-    {}
-
-    void OnInsertOrderRequest(
-        int id,
-        char side,
-        double price,
-        int quantity
-    );
-    
-    void OnReplaceOrderRequest(
-        int oldId, // The existing order to modify
-        int newId, // The new order ID to use if the modification succeeds
-        int deltaQuantity
-    );
-
-    void OnRequestAcknowledged(
-        int id
-    );
-
-    void OnRequestRejected(
-        int id
-    );
-
-    void OnOrderFilled(
-        int id,
-        int quantityFilled
-   );
-
-    // TimeComplexity: Theta(1)
-    int netFilledQuantity() const {
-        return nfq.value();
-    }
-    
-    // TimeComplexity: Theta(1)
-    double confirmedBidValue() const {
-        return cov.bidValue(); 
+    // Extra metrics see the same events as the built-in ones
+    BasicOrderTracker<FilledValue> fvt;
+    fvt.OnInsertOrderRequest(1, 'O', 12.5, 8);
+    fvt.OnRequestAcknowledged(1);
+    fvt.OnOrderFilled(1, 4);
+    if( fvt.metric<FilledValue>().value() != 50.0 || fvt.netFilledQuantity() != -4 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
 
-    // TimeComplexity: Theta(1)
-    double confirmedOfferValue() const {
-        return cov.offerValue();
+    // A burst delivered through OnEvents ends in the same state as the
+    //  same callbacks made one by one
+    std::vector<Listener::Event> burst;
+    for(int id = 1; id <= 30000; id += 3 ) {
+        burst.push_back( Listener::Event::insert(id, id % 2 ? 'B' : 'O', 5.0 + id % 11, 20) );
+        burst.push_back( Listener::Event::ack(id) );
+        burst.push_back( Listener::Event::fill(id, 5) );
+        burst.push_back( Listener::Event::replace(id, id + 1, id % 4 ? 5 : -5) );
+        burst.push_back( id % 5 ? Listener::Event::ack(id + 1) : Listener::Event::reject(id + 1) );
+        burst.push_back( Listener::Event::fill(id % 5 ? id + 1 : id, 3) );
     }
-
-    // TimeComplexity: Theta(1)
-    double pendingBidMinValue() const {
-        return pov.bidMinValue();
+    OrderTracker one, batched;
+    for(auto& e: burst ) Listener::dispatch( one, e );
+    Listener& asListener = batched;
+    asListener.OnEvents( burst.data(), burst.size() );
+    Exposure a = one.snapshot(), b = batched.snapshot();
+    if( a.netFilledQuantity != b.netFilledQuantity || a.confirmedBidValue != b.confirmedBidValue
+        || a.pendingOfferMaxValue != b.pendingOfferMaxValue || a.pendingBidMinValue != b.pendingBidMinValue
+        || one.memoryUsage().liveOrders != batched.memoryUsage().liveOrders ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
 
-    // TimeComplexity: Theta(1)
-    double pendingBidMaxValue() const {
-        return pov.bidMaxValue();
+    // Ladder queries by price and distance from the touch
+    LadderOrderTracker lot;
+    lot.metric<ExposureLadder>().setTickSize(0.5);
+    lot.OnInsertOrderRequest(1, 'B', 10.0, 10);
+    lot.OnInsertOrderRequest(2, 'B', 9.5, 10);
+    lot.OnInsertOrderRequest(3, 'B', 8.0, 10);
+    lot.OnInsertOrderRequest(4, 'O', 11.0, 10);
+    lot.OnInsertOrderRequest(5, 'O', 12.0, 10);
+    for(int id = 1; id <= 5; ++id ) lot.OnRequestAcknowledged(id);
+    lot.OnOrderFilled(1, 4);
+    lot.OnReplaceOrderRequest(5, 6, 10);
+    const ExposureLadder& ladder = lot.metric<ExposureLadder>();
+    if( ladder.confirmedValueAtOrBetter(Side::Bid, 9.5) != 60.0 + 95.0
+        || ladder.confirmedValueAtOrBetter(Side::Bid, 1.0) != lot.confirmedBidValue()
+        || ladder.confirmedValueAtOrBetter(Side::Offer, 11.5) != 110.0
+        || ladder.touch(Side::Bid) != 10.0 || ladder.touch(Side::Offer) != 11.0
+        || ladder.pendingMaxValueNearTouch(Side::Bid, 1) != 60.0 + 95.0
+        || ladder.pendingMaxValueNearTouch(Side::Offer, 2) != 110.0 + 240.0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    // Touch moves once the best bid is filled, far away prices grow the ladder
+    lot.OnOrderFilled(1, 6);
+    lot.OnInsertOrderRequest(7, 'B', 0.5, 10);
+    lot.OnInsertOrderRequest(8, 'B', 5000.0, 1);
+    lot.OnRequestRejected(8);
+    if( ladder.touch(Side::Bid) != 9.5 || ladder.confirmedValueAtOrBetter(Side::Bid, 9.5) != 95.0
+        || ladder.pendingMaxValueNearTouch(Side::Bid, 100) != lot.pendingBidMaxValue() ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
 
-    // TimeComplexity: Theta(1)
-    double pendingOfferMinValue() const {
-        return pov.offerMinValue();
+    // A fat finger price does not grow the ladder beyond its bound: the
+    //  ladder stretches its window towards it, and counts it at the end
+    LadderOrderTracker fat;
+    fat.metric<ExposureLadder>().setTickSize(0.01);
+    fat.metric<ExposureLadder>().setMaxTicks(4096);
+    fat.OnInsertOrderRequest(1, 'B', 100.0, 10);
+    fat.OnInsertOrderRequest(2, 'O', 101.0, 10);
+    fat.OnInsertOrderRequest(3, 'B', 1e7, 1);
+    fat.OnInsertOrderRequest(4, 'O', 1.0, 5);
+    for(int id = 1; id <= 4; ++id ) fat.OnRequestAcknowledged(id);
+    const ExposureLadder& fatLadder = fat.metric<ExposureLadder>();
+    double bidEnd = fatLadder.touch(Side::Bid), offerEnd = fatLadder.touch(Side::Offer);
+    if( fatLadder.getMaxTicks() != 4096
+        || !( bidEnd > 100.0 && bidEnd < 100.0 + 40.96 ) || !( offerEnd < 101.0 && offerEnd > 101.0 - 40.96 )
+        || fatLadder.confirmedValueAtOrBetter(Side::Bid, 100.0) != fat.confirmedBidValue()
+        || fatLadder.confirmedValueAtOrBetter(Side::Offer, 101.0) != fat.confirmedOfferValue()
+        || fatLadder.confirmedValueAtOrBetter(Side::Bid, 100.01) != 1e7 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
-    
-    // TimeComplexity: Theta(1)
-    double pendingOfferMaxValue() const {
-        return pov.offerMaxValue();
+    // and takes it out of the same bucket
+    fat.OnOrderFilled(3, 1);
+    fat.OnOrderFilled(4, 5);
+    if( fatLadder.touch(Side::Bid) != 100.0 || fatLadder.touch(Side::Offer) != 101.0
+        || fatLadder.confirmedValueAtOrBetter(Side::Bid, 1.0) != 1000.0
+        || fatLadder.pendingMaxValueNearTouch(Side::Offer, 4096) != 1010.0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
-private:
-   OrderStore orders;
-   PendingReplace pendingReplaces;
-   
-   NetFilledQuantity nfq;
-   ConfirmedOrderValue cov;
-   PendingOrderValue pov;
-};
-
 
-// Pre-Condition: id is unique and has never been seen before
-// TimeComplexity: O(1) - Amortized cost
-void OrderTracker::OnInsertOrderRequest(
-    int id,
-    char side,
-    double price,
-    int quantity
-) {
-    OrderInfo order(side, price, quantity);
-    orders.emplace(id, order); 
-    pov.notifyInsert( order );
-}
-    
-// TimeComplexity: O(1) - Amortized cost
-void OrderTracker::OnReplaceOrderRequest(
-    int oldId, // The existing order to modify
-    int newId, // The new order ID to use if the modification succeeds
-    int deltaQuantity
-) {
-    pendingReplaces.emplace( oldId, ReplaceInfo{newId, deltaQuantity});
-}
-
-//Simple Utility to merge values of OrderInfo to ReplaceInfo
-OrderInfo mergeOrderInfo(const OrderInfo& order, const ReplaceInfo& replace) {
-    return OrderInfo(order.side, order.price, order.quantity + replace.deltaQty );
-}
-
-// TimeComplexity: O(1)- Amortized Cost
-void OrderTracker::OnRequestAcknowledged(
-   int id
-) {
-
-    // Find if it was a pending replace.
-    auto iter = pendingReplaces.find( id );
-    if( iter != pendingReplaces.end() ) {
-        auto& replaceInfo = iter->second;
-        // Update Id to replaceInfo.newID and 
-        // Update Quantity to replaceInfo.deltaQty + order.quantity and 
-        auto orig_order_iter = orders.find( id );
-        assert( orig_order_iter != orders.end() );
-        orders.emplace( replaceInfo.newId, mergeOrderInfo( orig_order_iter->second, replaceInfo) );
-
-        // Cleanup
-        pendingReplaces.erase( iter );
-        orders.erase( orig_order_iter );
+    // Ids falling behind the dense window are kept as stragglers
+    OrderStore store(4);
+    const int ids[] = { 100, 101, 103, 110, 102, 5, 111, 200 };
+    for(int id: ids ) store.insert( id, OrderSlot::State::Active ).order.quantity = id;
+    store.erase( 110 );
+    for(int id: ids ) {
+        const OrderSlot* slot = store.find( id );
+        bool expected = ( id != 110 );
+        if( ( slot != nullptr ) != expected || ( slot != nullptr && slot->order.quantity != id ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << " for id " << id << std::endl;
+            return -1;
+        }
+    }
+    if( store.find( 104 ) != nullptr || store.size() != 7 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
     }
-    nfq.notifyAck( id );
-    cov.notifyAck( id );
-    pov.notifyAck( id );
-}
-
-// TimeComplexity: O(1)
-void OrderTracker::OnRequestRejected(
-    int id
-) {
-    nfq.notifyReject( id );
-    pov.notifyReject( id );
-}
-
-// TimeComplexity: O(1)
-void OrderTracker::OnOrderFilled(
-     int id,
-     int quantityFilled
-) {
-    auto iter = orders.find( id );
-    assert( iter != orders.end() );
-    auto& order = iter->second;
-    order.quantity -= quantityFilled;
-    nfq.notifyFill( id, quantityFilled );
-    cov.notifyFill( id, quantityFilled );
-    pov.notifyFill( id, quantityFilled );
-}
-    
-std::ostream& operator<<(std::ostream& out, const OrderTracker& ot) {
-    out << "NFQ: " << ot.netFilledQuantity()
-        << ", COV-Bid: " << ot.confirmedBidValue()
-        << ", COV-Offer: " << ot.confirmedOfferValue()
-        << ", POV-Bid-Min: " << ot.pendingBidMinValue() 
-        << ", POV-Bid-Max: " << ot.pendingBidMaxValue() 
-        << ", POV-Offer-Min: " << ot.pendingOfferMinValue() 
-        << ", POV-Offer-Max: " << ot.pendingOfferMaxValue();
-
-    return out;
-}
-
-
-// Test Program which tries the test cases provided in the assignment
-int main() {
-    OrderTracker ot;
-    ot.OnInsertOrderRequest(1, 'B', 10.0, 10);
-    std::cout << ot << std::endl;
-    ot.OnRequestAcknowledged(1);
-    std::cout << ot << std::endl;
-    ot.OnInsertOrderRequest(2, 'O', 15.0, 25);
-    std::cout << ot << std::endl;
-    ot.OnRequestAcknowledged(2);
-    std::cout << ot << std::endl;
-    ot.OnOrderFilled(1, 5);
-    std::cout << ot << std::endl;
-    ot.OnOrderFilled(1, 5);
-    std::cout << ot << std::endl;
-    ot.OnReplaceOrderRequest(2, 3, 10);
-    std::cout << ot << std::endl;
-    ot.OnOrderFilled(2, 25);
-    std::cout << ot << std::endl;
-    ot.OnRequestRejected(3);
-    std::cout << ot << std::endl;
 
     return 0;
 }
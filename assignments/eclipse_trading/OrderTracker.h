@@ -0,0 +1,825 @@
+#ifndef ORDER_TRACKER_H
+#define ORDER_TRACKER_H
+
+#include <cassert>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+#include "Listener.h"
+#include "SeqLock.h"
+
+enum class Side : char{
+    Bid = 'B',
+    Offer = 'O'
+};
+
+// OrderInfo is used to hold all parameters associated with an Insert Order Request
+struct OrderInfo {
+    Side side;
+    double price;
+    int quantity;
+
+    OrderInfo() = default;
+    OrderInfo(const OrderInfo&) = default;
+    OrderInfo(OrderInfo&&) = default;
+
+    OrderInfo& operator=(const OrderInfo&) = default;
+    OrderInfo& operator=(OrderInfo&&) = default;
+
+    OrderInfo(char s, double p, int q) 
+        : side( static_cast<Side>(s) )
+        , price( p )
+        , quantity( q )
+    {}
+
+    OrderInfo(Side s, double p, int q) 
+        : side( s )
+        , price( p )
+        , quantity( q)
+    {}
+    
+};
+
+constexpr int NoId = std::numeric_limits<int>::min();
+
+// OrderSlot holds everything known about an order id. A pending replace is
+//  kept inline: the slot of the original order records the new id and the
+//  quantity delta, while the slot of the new id records the original id
+//  until the replace is acknowledged or rejected.
+//  Orders only occupy a slot while they can still receive events; once an
+//  order reaches a terminal state (rejected, fully filled or replaced) its
+//  slot is released.
+struct OrderSlot {
+    enum class State : char {
+        Free,
+        PendingInsert,  // inserted, waiting for the ack
+        Active,         // acknowledged and (partially) open
+        ReplaceRequest  // new id of a pending replace; replaceId is the original order
+    };
+
+    OrderInfo order;
+    int replaceId = NoId;   // Active: new id of the pending replace, if any
+    int replaceDelta = 0;
+    State state = State::Free;
+
+    bool isFree() const { return state == State::Free; }
+    bool isOrder() const { return state == State::PendingInsert || state == State::Active; }
+    bool hasPendingReplace() const { return replaceId != NoId; }
+
+    // No further event can refer to the order
+    bool isDone() const { return state == State::Active && order.quantity <= 0 && !hasPendingReplace(); }
+};
+
+// OrderStore maps order ids to slots. Order ids are expected to be mostly
+//  increasing, so the most recent ids live in a dense window indexed by
+//  'id - base', held in a ring buffer of power-of-two size. When an id
+//  beyond the window arrives the window slides forward, and live slots
+//  falling off its back (along with ids older than the window) move to an
+//  open-addressing hash table of stragglers.
+class OrderStore {
+public:
+    explicit OrderStore(std::size_t windowSize = 1 << 16)
+        : window( roundUpToPowerOfTwo( windowSize ) )
+        , mask( window.size() - 1 )
+    {}
+
+    // TimeComplexity: Theta(1) within the window, O(1) - Amortized Cost otherwise
+    OrderSlot* find(int id) {
+        if( inWindow( id ) ) {
+            OrderSlot& slot = window[ id & mask ];
+            return slot.isFree() ? nullptr : &slot;
+        }
+        return stragglerCount == 0 ? nullptr : findStraggler( id );
+    }
+
+    const OrderSlot* find(int id) const {
+        return const_cast<OrderStore*>(this)->find( id );
+    }
+
+    // Pre-Condition: id is not in the store and state is not Free
+    // TimeComplexity: O(1) - Amortized Cost
+    OrderSlot& insert(int id, OrderSlot::State state) {
+        if( liveInWindow == 0 && stragglerCount == 0 ) base = id;
+        if( id >= base && !inWindow( id ) ) slide( id );
+
+        OrderSlot* slot;
+        if( inWindow( id ) ) {
+            slot = &window[ id & mask ];
+            ++liveInWindow;
+        } else {
+            slot = &insertStraggler( id );
+        }
+        *slot = OrderSlot();
+        slot->state = state;
+        return *slot;
+    }
+
+    // TimeComplexity: O(1) - Amortized Cost
+    void erase(int id) {
+        if( inWindow( id ) ) {
+            OrderSlot& slot = window[ id & mask ];
+            if( !slot.isFree() ) {
+                slot.state = OrderSlot::State::Free;
+                --liveInWindow;
+            }
+            return;
+        }
+        eraseStraggler( id );
+    }
+
+    // Hints the cache to load the slot of id, if it lies in the window
+    // TimeComplexity: Theta(1)
+    void prefetch(int id) const {
+        if( inWindow( id ) ) __builtin_prefetch( &window[ id & mask ] );
+    }
+
+    std::size_t size() const { return liveInWindow + stragglerCount; }
+
+    struct MemoryUsage {
+        std::size_t liveOrders;
+        std::size_t windowSlots;
+        std::size_t stragglers;
+        std::size_t stragglerSlots;
+        std::size_t bytes;
+    };
+
+    // TimeComplexity: Theta(1)
+    MemoryUsage memoryUsage() const {
+        return MemoryUsage{
+            size(),
+            window.capacity(),
+            stragglerCount,
+            stragglers.capacity(),
+            window.capacity() * sizeof(OrderSlot) + stragglers.capacity() * sizeof(Straggler)
+        };
+    }
+private:
+    struct Straggler {
+        enum class State : char { Empty, Used, Erased };
+        int id = 0;
+        State state = State::Empty;
+        OrderSlot slot;
+    };
+
+    std::vector<OrderSlot> window;
+    std::size_t mask;
+    long long base = 0;
+    std::size_t liveInWindow = 0;
+
+    static constexpr std::size_t MinStragglerSlots = 16;
+    std::vector<Straggler> stragglers;
+    std::size_t stragglerCount = 0;
+    std::size_t stragglerTombstones = 0;
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t p = 1;
+        while( p < n ) p <<= 1;
+        return p;
+    }
+
+    bool inWindow(int id) const {
+        return id >= base && id - base < static_cast<long long>( window.size() );
+    }
+
+    // Moves the window so that it ends at id, handing live slots which
+    //  fall off the back to the straggler table
+    void slide(int id) {
+        long long newBase = static_cast<long long>(id) - static_cast<long long>( window.size() ) + 1;
+        long long last = std::min( newBase, base + static_cast<long long>( window.size() ) );
+        for( long long old = base; old < last && liveInWindow > 0; ++old ) {
+            OrderSlot& slot = window[ old & mask ];
+            if( slot.isFree() ) continue;
+            insertStraggler( static_cast<int>(old) ) = slot;
+            slot.state = OrderSlot::State::Free;
+            --liveInWindow;
+        }
+        base = newBase;
+    }
+
+    static std::size_t hash(int id) {
+        return static_cast<std::size_t>( static_cast<unsigned>(id) * 2654435761u );
+    }
+
+    Straggler* findStragglerEntry(int id) {
+        std::size_t cap = stragglers.size();
+        for( std::size_t i = hash( id ) & ( cap - 1 ); ; i = ( i + 1 ) & ( cap - 1 ) ) {
+            Straggler& s = stragglers[i];
+            if( s.state == Straggler::State::Empty ) return nullptr;
+            if( s.state == Straggler::State::Used && s.id == id ) return &s;
+        }
+    }
+
+    OrderSlot* findStraggler(int id) {
+        Straggler* s = findStragglerEntry( id );
+        return s == nullptr ? nullptr : &s->slot;
+    }
+
+    OrderSlot& insertStraggler(int id) {
+        if( ( stragglerCount + stragglerTombstones + 1 ) * 2 > stragglers.size() ) rehash();
+
+        std::size_t cap = stragglers.size();
+        std::size_t i = hash( id ) & ( cap - 1 );
+        while( stragglers[i].state == Straggler::State::Used ) i = ( i + 1 ) & ( cap - 1 );
+
+        Straggler& s = stragglers[i];
+        if( s.state == Straggler::State::Erased ) --stragglerTombstones;
+        s.id = id;
+        s.state = Straggler::State::Used;
+        ++stragglerCount;
+        return s.slot;
+    }
+
+    void eraseStraggler(int id) {
+        if( stragglerCount == 0 ) return;
+        Straggler* s = findStragglerEntry( id );
+        if( s == nullptr ) return;
+
+        s->state = Straggler::State::Erased;
+        --stragglerCount;
+        ++stragglerTombstones;
+
+        // Give memory back once stragglers are reclaimed, so that the table
+        //  stays proportional to the stragglers still open
+        if( stragglers.size() > MinStragglerSlots && stragglerCount * 8 < stragglers.size() ) rehash();
+    }
+
+    void rehash() {
+        std::vector<Straggler> old;
+        old.swap( stragglers );
+        std::size_t slots = roundUpToPowerOfTwo( ( stragglerCount + 1 ) * 4 );
+        if( slots < MinStragglerSlots ) slots = MinStragglerSlots;
+        stragglers = std::vector<Straggler>( slots );
+        stragglerCount = 0;
+        stragglerTombstones = 0;
+        for(auto& s: old ) {
+            if( s.state == Straggler::State::Used ) insertStraggler( s.id ) = s.slot;
+        }
+    }
+};
+
+
+// Accumulators are told about every event along with the order it applies
+//  to, which the tracker has already looked up, so an event costs a single
+//  store lookup however many accumulators are plugged in. An accumulator
+//  only needs to implement the notifications it cares about: the rest are
+//  inherited from NoOpAccumulator.
+//  Notifications:
+//   notifyInsert(order), notifyAck(order), notifyReject(order)
+//   notifyReplace(order, deltaQty) - order as before the replace
+//   notifyReplaceAck(order, deltaQty) - order already carries the new quantity
+//   notifyReplaceReject(order, deltaQty) - order as before the replace
+//   notifyFill(order, qtyFilled)
+struct NoOpAccumulator {
+    void notifyInsert(const OrderInfo&) {}
+    void notifyAck(const OrderInfo&) {}
+    void notifyReject(const OrderInfo&) {}
+    void notifyReplace(const OrderInfo&, int) {}
+    void notifyReplaceAck(const OrderInfo&, int) {}
+    void notifyReplaceReject(const OrderInfo&, int) {}
+    void notifyFill(const OrderInfo&, int) {}
+};
+
+// A Simple Accumulator class which "Accumulates" Net Filled Quantity.
+//  In order to keep extracting this value efficient, we keep track of 
+//  NFQ known so far. notifyFill does the most of work by re-computing
+//   (and hence accumulating) NFQ.
+struct NetFilledQuantity: NoOpAccumulator {
+    // TimeComplexity: Theta(1)
+    void notifyFill(const OrderInfo& order, int qtyFilled ) {
+        switch( order.side ) {
+            case Side::Bid:
+                val += qtyFilled;
+                break;
+            case Side::Offer:
+                val -= qtyFilled;
+                break;
+        }
+    }
+
+    int value() const { return val; } // TimeComplexity: Theta(1)
+private:
+    int val= 0;;
+};
+
+// A Simple Accumulator class which "Accumulates" Confirmed Order Value.
+//  In order to keep extracting this value efficient, we keep track of 
+//  COV for bid and offer sides separately. 
+//  notifyAck and notifyFill does the most of work by re-computing
+//   (and hence accumulating) COV.
+struct ConfirmedOrderValue: NoOpAccumulator {
+    // TimeComplexity: Theta(1)
+    void notifyAck(const OrderInfo& order) {
+        side( order.side ) += order.price * order.quantity;
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyReplaceAck(const OrderInfo& order, int deltaQty) {
+        side( order.side ) += order.price * deltaQty;
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyFill(const OrderInfo& order, int qtyFilled ) {
+        side( order.side ) -= order.price * qtyFilled;
+    }
+
+    double bidValue() const { return bid; } // TimeComplexity: Theta(1)
+    double offerValue() const { return offer; } // TimeComplexity: Theta(1)
+private:
+    double bid = 0.0;
+    double offer = 0.0;
+
+    double& side(Side s) { return s == Side::Bid ? bid : offer; }
+};
+
+// A Simple Accumulator class which "Accumulates" Pending Order Value.
+//  In order to keep extracting this value efficient, we keep track of 
+//  POV for bid and offer sides separately. Each of side has two values
+//  one for min and another for max.
+//  A pending insert may add its value (max) or not (min). A pending
+//  replace may change the value by price * deltaQty (max if the delta is
+//  positive, min otherwise) or leave it unchanged.
+//  notifyInsert, notifyReplace, notifyAck, notifyReject and notifyFill
+//   does the most of work by re-computing (and hence accumulating) POV.
+struct PendingOrderValue: NoOpAccumulator {
+    // TimeComplexity: Theta(1)
+    void notifyInsert(const OrderInfo& order) {
+        bounds( order.side ).max += order.price * order.quantity;
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyAck(const OrderInfo& order) {
+        bounds( order.side ).min += order.price * order.quantity;
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyReject(const OrderInfo& order) {
+        bounds( order.side ).max -= order.price * order.quantity;
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyReplace(const OrderInfo& order, int deltaQty) {
+        bounds( order.side ).widen( order.price * deltaQty );
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyReplaceAck(const OrderInfo& order, int deltaQty) {
+        bounds( order.side ).settle( order.price * deltaQty );
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyReplaceReject(const OrderInfo& order, int deltaQty) {
+        bounds( order.side ).retract( order.price * deltaQty );
+    }
+
+    // TimeComplexity: Theta(1)
+    void notifyFill(const OrderInfo& order, int qtyFilled ) {
+        auto& b = bounds( order.side );
+        b.min -= order.price * qtyFilled;
+        b.max -= order.price * qtyFilled;
+    }
+
+    double bidMinValue() const { return bid.min; } // TimeComplexity: Theta(1)
+    double bidMaxValue() const { return bid.max; } // TimeComplexity: Theta(1)
+    double offerMinValue() const { return offer.min; } // TimeComplexity: Theta(1)
+    double offerMaxValue() const { return offer.max; } // TimeComplexity: Theta(1)
+private:
+    struct Bounds {
+        double min = 0.0;
+        double max = 0.0;
+
+        // A pending change may or may not happen
+        void widen(double delta) {
+            if( delta > 0 ) max += delta; else min += delta;
+        }
+
+        // A pending change did happen
+        void settle(double delta) {
+            if( delta > 0 ) min += delta; else max += delta;
+        }
+
+        // A pending change did not happen
+        void retract(double delta) {
+            if( delta > 0 ) max -= delta; else min -= delta;
+        }
+    };
+
+    Bounds bid;
+    Bounds offer;
+
+    Bounds& bounds(Side s) { return s == Side::Bid ? bid : offer; }
+};
+
+// AccumulatorPack composes accumulators at compile time: every
+//  notification is forwarded to each accumulator in turn through plain
+//  (inlinable) member calls, in the order they are listed.
+template<typename... Accumulators>
+struct AccumulatorPack: Accumulators... {
+    void notifyInsert(const OrderInfo& order) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyInsert( order ), 0 )... };
+    }
+
+    void notifyAck(const OrderInfo& order) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyAck( order ), 0 )... };
+    }
+
+    void notifyReject(const OrderInfo& order) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyReject( order ), 0 )... };
+    }
+
+    void notifyReplace(const OrderInfo& order, int deltaQty) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyReplace( order, deltaQty ), 0 )... };
+    }
+
+    void notifyReplaceAck(const OrderInfo& order, int deltaQty) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyReplaceAck( order, deltaQty ), 0 )... };
+    }
+
+    void notifyReplaceReject(const OrderInfo& order, int deltaQty) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyReplaceReject( order, deltaQty ), 0 )... };
+    }
+
+    void notifyFill(const OrderInfo& order, int qtyFilled) {
+        (void)Expand{ 0, ( static_cast<Accumulators&>(*this).notifyFill( order, qtyFilled ), 0 )... };
+    }
+
+    template<typename Accumulator>
+    const Accumulator& get() const { return static_cast<const Accumulator&>(*this); }
+
+    template<typename Accumulator>
+    Accumulator& get() { return static_cast<Accumulator&>(*this); }
+private:
+    using Expand = int[];
+};
+
+
+// NFQ, COV and POV of a set of orders
+struct Exposure {
+    long long netFilledQuantity = 0;
+    double confirmedBidValue = 0.0;
+    double confirmedOfferValue = 0.0;
+    double pendingBidMinValue = 0.0;
+    double pendingBidMaxValue = 0.0;
+    double pendingOfferMinValue = 0.0;
+    double pendingOfferMaxValue = 0.0;
+
+    template<typename Tracker>
+    static Exposure of(const Tracker& t) {
+        Exposure e;
+        e.netFilledQuantity = t.netFilledQuantity();
+        e.confirmedBidValue = t.confirmedBidValue();
+        e.confirmedOfferValue = t.confirmedOfferValue();
+        e.pendingBidMinValue = t.pendingBidMinValue();
+        e.pendingBidMaxValue = t.pendingBidMaxValue();
+        e.pendingOfferMinValue = t.pendingOfferMinValue();
+        e.pendingOfferMaxValue = t.pendingOfferMaxValue();
+        return e;
+    }
+
+    Exposure& operator+=(const Exposure& rhs) {
+        netFilledQuantity += rhs.netFilledQuantity;
+        confirmedBidValue += rhs.confirmedBidValue;
+        confirmedOfferValue += rhs.confirmedOfferValue;
+        pendingBidMinValue += rhs.pendingBidMinValue;
+        pendingBidMaxValue += rhs.pendingBidMaxValue;
+        pendingOfferMinValue += rhs.pendingOfferMinValue;
+        pendingOfferMaxValue += rhs.pendingOfferMaxValue;
+        return *this;
+    }
+
+    Exposure& operator-=(const Exposure& rhs) {
+        netFilledQuantity -= rhs.netFilledQuantity;
+        confirmedBidValue -= rhs.confirmedBidValue;
+        confirmedOfferValue -= rhs.confirmedOfferValue;
+        pendingBidMinValue -= rhs.pendingBidMinValue;
+        pendingBidMaxValue -= rhs.pendingBidMaxValue;
+        pendingOfferMinValue -= rhs.pendingOfferMinValue;
+        pendingOfferMaxValue -= rhs.pendingOfferMaxValue;
+        return *this;
+    }
+};
+
+inline Exposure operator-(Exposure lhs, const Exposure& rhs) { return lhs -= rhs; }
+
+
+// BasicOrderTracker implemets the Listener interface and provides functions to fetch
+//  Net Filled Quantity
+//  Confirmed Order Value, and
+//  Pending Order Value
+//  Additional metrics can be plugged in as accumulators, see NoOpAccumulator,
+//  and are fetched through metric<Accumulator>().
+//  The getters are meant for the callback thread. Other threads take a
+//  snapshot() instead: all seven values are republished through a seqlock
+//  at the end of every callback.
+template<typename... Metrics>
+class BasicOrderTracker: public Listener {
+public:
+    // Ids within 'windowSize' of the most recent id are looked up directly
+    explicit BasicOrderTracker(std::size_t windowSize = 1 << 16)
+        : orders(windowSize)
+    {}
+
+    void OnInsertOrderRequest(
+        int id,
+        char side,
+        double price,
+        int quantity
+    ) {
+        insertOrder( id, side, price, quantity );
+        publish();
+    }
+    
+    void OnReplaceOrderRequest(
+        int oldId, // The existing order to modify
+        int newId, // The new order ID to use if the modification succeeds
+        int deltaQuantity
+    ) {
+        replaceOrder( oldId, newId, deltaQuantity );
+        publish();
+    }
+
+    void OnRequestAcknowledged(
+        int id
+    ) {
+        acknowledge( id );
+        publish();
+    }
+
+    void OnRequestRejected(
+        int id
+    ) {
+        reject( id );
+        publish();
+    }
+
+    void OnOrderFilled(
+        int id,
+        int quantityFilled
+   ) {
+        fill( id, quantityFilled );
+        publish();
+    }
+
+    // Applies a burst of events without virtual calls, prefetching the
+    //  slots of upcoming events, and publishes the snapshot once at the end
+    void OnEvents(
+        const Event* events,
+        std::size_t count
+    );
+
+    // Applies an event without republishing the snapshot, for owners which
+    //  publish figures of their own (see TrackerEngine)
+    // TimeComplexity: O(1) - Amortized Cost
+    void apply(const Event& e);
+
+    // TimeComplexity: Theta(1)
+    int netFilledQuantity() const {
+        return metric<NetFilledQuantity>().value();
+    }
+    
+    // TimeComplexity: Theta(1)
+    double confirmedBidValue() const {
+        return metric<ConfirmedOrderValue>().bidValue(); 
+    }
+
+    // TimeComplexity: Theta(1)
+    double confirmedOfferValue() const {
+        return metric<ConfirmedOrderValue>().offerValue();
+    }
+
+    // TimeComplexity: Theta(1)
+    double pendingBidMinValue() const {
+        return metric<PendingOrderValue>().bidMinValue();
+    }
+
+    // TimeComplexity: Theta(1)
+    double pendingBidMaxValue() const {
+        return metric<PendingOrderValue>().bidMaxValue();
+    }
+
+    // TimeComplexity: Theta(1)
+    double pendingOfferMinValue() const {
+        return metric<PendingOrderValue>().offerMinValue();
+    }
+    
+    // TimeComplexity: Theta(1)
+    double pendingOfferMaxValue() const {
+        return metric<PendingOrderValue>().offerMaxValue();
+    }
+
+    // TimeComplexity: Theta(1)
+    template<typename Accumulator>
+    const Accumulator& metric() const {
+        return accumulators.template get<Accumulator>();
+    }
+
+    // For configuring a metric before the first callback
+    template<typename Accumulator>
+    Accumulator& metric() {
+        return accumulators.template get<Accumulator>();
+    }
+
+    // All seven values as of the end of the last callback. Safe to call
+    //  from any thread while callbacks keep coming.
+    // TimeComplexity: Theta(1), retried while overlapping a callback
+    Exposure snapshot() const {
+        return published.load();
+    }
+
+    // Orders (and pending replaces) which can still receive events, along
+    //  with the memory held to track them
+    // TimeComplexity: Theta(1)
+    OrderStore::MemoryUsage memoryUsage() const {
+        return orders.memoryUsage();
+    }
+private:
+   OrderStore orders;
+   AccumulatorPack<NetFilledQuantity, ConfirmedOrderValue, PendingOrderValue, Metrics...> accumulators;
+   SeqLock<Exposure> published;
+
+   void publish() {
+       published.store( Exposure::of( *this ) );
+   }
+
+   void insertOrder(int id, char side, double price, int quantity);
+   void replaceOrder(int oldId, int newId, int deltaQuantity);
+   void acknowledge(int id);
+   void reject(int id);
+   void fill(int id, int quantityFilled);
+
+   void acknowledgeReplace(int newId, OrderSlot& request);
+   void rejectReplace(int newId, OrderSlot& request);
+};
+
+using OrderTracker = BasicOrderTracker<>;
+
+
+// Pre-Condition: id is unique and has never been seen before
+// TimeComplexity: O(1) - Amortized cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::insertOrder(
+    int id,
+    char side,
+    double price,
+    int quantity
+) {
+    OrderSlot& slot = orders.insert( id, OrderSlot::State::PendingInsert );
+    slot.order = OrderInfo(side, price, quantity);
+    accumulators.notifyInsert( slot.order );
+}
+    
+// Pre-Condition: oldId is an acknowledged order without a pending replace
+//  and newId has never been seen before
+// TimeComplexity: O(1) - Amortized cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::replaceOrder(
+    int oldId, // The existing order to modify
+    int newId, // The new order ID to use if the modification succeeds
+    int deltaQuantity
+) {
+    OrderSlot* slot = orders.find( oldId );
+    assert( slot != nullptr && slot->state == OrderSlot::State::Active );
+    slot->replaceId = newId;
+    slot->replaceDelta = deltaQuantity;
+    accumulators.notifyReplace( slot->order, deltaQuantity );
+
+    // slot may move when newId makes the window slide
+    OrderSlot& request = orders.insert( newId, OrderSlot::State::ReplaceRequest );
+    request.replaceId = oldId;
+    request.replaceDelta = deltaQuantity;
+}
+
+// Acknowledgements and rejections of a replace refer to the new id
+// TimeComplexity: O(1)- Amortized Cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::acknowledge(
+   int id
+) {
+    OrderSlot* slot = orders.find( id );
+    assert( slot != nullptr );
+
+    if( slot->state == OrderSlot::State::ReplaceRequest ) {
+        acknowledgeReplace( id, *slot );
+    } else {
+        assert( slot->state == OrderSlot::State::PendingInsert );
+        slot->state = OrderSlot::State::Active;
+        accumulators.notifyAck( slot->order );
+    }
+}
+
+// TimeComplexity: O(1)- Amortized Cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::reject(
+    int id
+) {
+    OrderSlot* slot = orders.find( id );
+    assert( slot != nullptr );
+
+    if( slot->state == OrderSlot::State::ReplaceRequest ) {
+        rejectReplace( id, *slot );
+    } else {
+        // A rejected insert was never active in the market
+        accumulators.notifyReject( slot->order );
+        orders.erase( id );
+    }
+}
+
+// Order is now tracked by the new id with its quantity updated by the delta
+// TimeComplexity: O(1)- Amortized Cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::acknowledgeReplace(int newId, OrderSlot& request) {
+    int oldId = request.replaceId;
+    int delta = request.replaceDelta;
+    OrderSlot* original = orders.find( oldId );
+    assert( original != nullptr );
+
+    request.state = OrderSlot::State::Active;
+    request.order = original->order;
+    request.order.quantity += delta;
+    request.replaceId = NoId;
+    request.replaceDelta = 0;
+    accumulators.notifyReplaceAck( request.order, delta );
+
+    // Erasing may move slots, so it comes last
+    bool done = request.isDone();
+    orders.erase( oldId );
+    if( done ) orders.erase( newId );
+}
+
+// Order remains tracked by its original id
+// TimeComplexity: O(1)- Amortized Cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::rejectReplace(int newId, OrderSlot& request) {
+    int oldId = request.replaceId;
+    int delta = request.replaceDelta;
+    OrderSlot* original = orders.find( oldId );
+    assert( original != nullptr );
+
+    original->replaceId = NoId;
+    original->replaceDelta = 0;
+    accumulators.notifyReplaceReject( original->order, delta );
+
+    // The order may have been fully filled while the replace was pending
+    bool done = original->isDone();
+    orders.erase( newId );
+    if( done ) orders.erase( oldId );
+}
+
+// TimeComplexity: O(1)- Amortized Cost
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::fill(
+     int id,
+     int quantityFilled
+) {
+    auto slot = orders.find( id );
+    assert( slot != nullptr && slot->isOrder() );
+    auto& order = slot->order;
+    order.quantity -= quantityFilled;
+    accumulators.notifyFill( order, quantityFilled );
+    if( slot->isDone() ) orders.erase( id );
+}
+    
+// TimeComplexity: O(N) - Amortized cost for N events
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::OnEvents(
+    const Event* events,
+    std::size_t count
+) {
+    constexpr std::size_t PrefetchDistance = 8;
+    for( std::size_t i = 0; i < count && i < PrefetchDistance; ++i ) orders.prefetch( events[i].id );
+    for( std::size_t i = 0; i < count; ++i ) {
+        if( i + PrefetchDistance < count ) orders.prefetch( events[i + PrefetchDistance].id );
+        apply( events[i] );
+    }
+    publish();
+}
+
+template<typename... Metrics>
+void BasicOrderTracker<Metrics...>::apply(
+    const Event& e
+) {
+    switch( e.type ) {
+        case Event::Type::Insert: insertOrder( e.id, e.side, e.price, e.arg ); break;
+        case Event::Type::Replace: replaceOrder( e.id, e.arg, e.delta ); break;
+        case Event::Type::Ack: acknowledge( e.id ); break;
+        case Event::Type::Reject: reject( e.id ); break;
+        case Event::Type::Fill: fill( e.id, e.arg ); break;
+    }
+}
+
+template<typename... Metrics>
+std::ostream& operator<<(std::ostream& out, const BasicOrderTracker<Metrics...>& ot) {
+    out << "NFQ: " << ot.netFilledQuantity()
+        << ", COV-Bid: " << ot.confirmedBidValue()
+        << ", COV-Offer: " << ot.confirmedOfferValue()
+        << ", POV-Bid-Min: " << ot.pendingBidMinValue() 
+        << ", POV-Bid-Max: " << ot.pendingBidMaxValue() 
+        << ", POV-Offer-Min: " << ot.pendingOfferMinValue() 
+        << ", POV-Offer-Max: " << ot.pendingOfferMaxValue();
+
+    return out;
+}
+
+#endif // ORDER_TRACKER_H
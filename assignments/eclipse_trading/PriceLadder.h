@@ -0,0 +1,297 @@
+#ifndef PRICE_LADDER_H
+#define PRICE_LADDER_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "OrderTracker.h"
+
+// Fenwick (binary indexed) tree over N values: point updates and prefix
+//  sums in O(log N). The values themselves are kept as well, so that the
+//  tree can be rebuilt in Theta(N) when it has to grow.
+template<typename T>
+class Fenwick {
+public:
+    explicit Fenwick(std::size_t n = 0)
+        : values(n, T())
+        , tree(n, T())
+    {}
+
+    // TimeComplexity: Theta(log N)
+    void add(std::size_t i, T delta) {
+        values[i] += delta;
+        for( ++i; i <= tree.size(); i += i & ( ~i + 1 ) ) tree[i - 1] += delta;
+    }
+
+    // Sum of the values [0, i]
+    // TimeComplexity: Theta(log N)
+    T prefix(std::size_t i) const {
+        T sum = T();
+        for( ++i; i > 0; i -= i & ( ~i + 1 ) ) sum += tree[i - 1];
+        return sum;
+    }
+
+    // Sum of the values [first, last]
+    // TimeComplexity: Theta(log N)
+    T range(std::size_t first, std::size_t last) const {
+        return first == 0 ? prefix( last ) : prefix( last ) - prefix( first - 1 );
+    }
+
+    T total() const { return values.empty() ? T() : prefix( values.size() - 1 ); }
+
+    // Smallest i with prefix(i) >= target, size() if there is none.
+    // Pre-Condition: all values are non-negative
+    // TimeComplexity: Theta(log N)
+    std::size_t lowerBound(T target) const {
+        std::size_t pos = 0;
+        std::size_t step = 1;
+        while( step * 2 <= tree.size() ) step *= 2;
+        for( ; step > 0; step /= 2 ) {
+            if( pos + step <= tree.size() && tree[pos + step - 1] < target ) {
+                pos += step;
+                target -= tree[pos - 1];
+            }
+        }
+        return pos;
+    }
+
+    // Grows to n values, the existing ones moving up by 'shift'
+    // TimeComplexity: Theta(N)
+    void resize(std::size_t n, std::size_t shift) {
+        std::vector<T> grown( n, T() );
+        for( std::size_t i = 0; i < values.size(); ++i ) grown[i + shift] = values[i];
+        values.swap( grown );
+        tree = values;
+        for( std::size_t i = 1; i <= tree.size(); ++i ) {
+            std::size_t parent = i + ( i & ( ~i + 1 ) );
+            if( parent <= tree.size() ) tree[parent - 1] += tree[i - 1];
+        }
+    }
+
+    std::size_t size() const { return values.size(); }
+private:
+    std::vector<T> values;
+    std::vector<T> tree;
+};
+
+// ExposureLadder is an accumulator which keeps the confirmed value and the
+//  pending max value of each side per price tick, so that risk checks can
+//  ask for the value at or better than a price, or near the touch, in
+//  O(log N) for N ticks instead of walking the orders.
+//  The touch of a side is the best price with pending max quantity on it.
+//  Ticks cover the range of prices seen so far; the ladder grows (and is
+//  rebuilt) when a price outside that range arrives, up to a window of
+//  MaxTicks ticks per side. A side never grows beyond it, so an outlier (a
+//  fat finger 1e7 on a 0.01 tick) cannot blow up memory on the event path:
+//  a price out of the window's reach first stretches the window as far as
+//  the bound allows towards it, and is then counted in the end tick of the
+//  window on its side. The end ticks thus act as overflow buckets holding
+//  everything at or beyond them, and queries see those prices as sitting
+//  on the window's ends. The window is placed by the first prices seen, so
+//  MaxTicks should cover how far the prices of a session can wander.
+//  Prices are expected on the tick grid and are rounded to the nearest tick.
+class ExposureLadder: public NoOpAccumulator {
+public:
+    static constexpr std::size_t DefaultMaxTicks = std::size_t(1) << 16;
+
+    // Pre-Condition: no order has been seen yet
+    void setTickSize(double size) {
+        assert( bid.empty() && offer.empty() );
+        tickSize = size;
+    }
+
+    double getTickSize() const { return tickSize; }
+
+    // Bound of each side, rounded up to a power of two of at least
+    //  InitialTicks. Memory is 48 bytes per tick and side.
+    // Pre-Condition: no order has been seen yet
+    void setMaxTicks(std::size_t ticks) {
+        assert( bid.empty() && offer.empty() );
+        std::size_t n = InitialTicks;
+        while( n < ticks ) n *= 2;
+        bid.maxTicks = offer.maxTicks = n;
+    }
+
+    std::size_t getMaxTicks() const { return bid.maxTicks; }
+
+    // TimeComplexity: O(log N), plus Theta(N) when the ladder grows
+    void notifyInsert(const OrderInfo& order) {
+        side( order.side ).addPendingMax( tick( order.price ), order.price, order.quantity );
+    }
+
+    // TimeComplexity: O(log N)
+    void notifyAck(const OrderInfo& order) {
+        side( order.side ).addConfirmed( tick( order.price ), order.price, order.quantity );
+    }
+
+    // TimeComplexity: O(log N)
+    void notifyReject(const OrderInfo& order) {
+        side( order.side ).addPendingMax( tick( order.price ), order.price, -order.quantity );
+    }
+
+    // Mirrors PendingOrderValue: only an increase can raise the max
+    // TimeComplexity: O(log N)
+    void notifyReplace(const OrderInfo& order, int deltaQty) {
+        if( deltaQty > 0 ) side( order.side ).addPendingMax( tick( order.price ), order.price, deltaQty );
+    }
+
+    // TimeComplexity: O(log N)
+    void notifyReplaceAck(const OrderInfo& order, int deltaQty) {
+        auto& s = side( order.side );
+        auto t = tick( order.price );
+        s.addConfirmed( t, order.price, deltaQty );
+        if( deltaQty < 0 ) s.addPendingMax( t, order.price, deltaQty );
+    }
+
+    // TimeComplexity: O(log N)
+    void notifyReplaceReject(const OrderInfo& order, int deltaQty) {
+        if( deltaQty > 0 ) side( order.side ).addPendingMax( tick( order.price ), order.price, -deltaQty );
+    }
+
+    // TimeComplexity: O(log N)
+    void notifyFill(const OrderInfo& order, int qtyFilled) {
+        auto& s = side( order.side );
+        auto t = tick( order.price );
+        s.addConfirmed( t, order.price, -qtyFilled );
+        s.addPendingMax( t, order.price, -qtyFilled );
+    }
+
+    // Confirmed value of the orders at 'price' or better: at or above it
+    //  for bids, at or below it for offers
+    // TimeComplexity: O(log N)
+    double confirmedValueAtOrBetter(Side s, double price) const {
+        const Ladder& l = side( s );
+        if( l.empty() ) return 0.0;
+        long long t = tick( price );
+        return s == Side::Bid ? l.confirmedAbove( t ) : l.confirmedBelow( t );
+    }
+
+    // Pending max value of the orders from the touch up to 'ticks' ticks
+    //  away from it
+    // TimeComplexity: O(log N)
+    double pendingMaxValueNearTouch(Side s, int ticks) const {
+        const Ladder& l = side( s );
+        long long touch;
+        if( !l.touch( s, touch ) ) return 0.0;
+        return s == Side::Bid ? l.pendingMaxBetween( touch - ticks, touch )
+                              : l.pendingMaxBetween( touch, touch + ticks );
+    }
+
+    // Best price with pending max quantity on it, NaN if there is none.
+    //  An outlier beyond the window shows as the window's end.
+    // TimeComplexity: O(log N)
+    double touch(Side s) const {
+        long long t;
+        return side( s ).touch( s, t ) ? t * tickSize : std::numeric_limits<double>::quiet_NaN();
+    }
+private:
+    // One side of the ladder. Index i holds tick 'base + i'
+    struct Ladder {
+        long long base = 0;
+        std::size_t maxTicks = DefaultMaxTicks;
+        Fenwick<double> confirmed;
+        Fenwick<double> pendingMax;
+        Fenwick<long long> pendingMaxQty;
+
+        bool empty() const { return confirmed.size() == 0; }
+
+        void addConfirmed(long long t, double price, int qty) {
+            confirmed.add( index( t ), price * qty );
+        }
+
+        void addPendingMax(long long t, double price, int qty) {
+            std::size_t i = index( t );
+            pendingMax.add( i, price * qty );
+            pendingMaxQty.add( i, qty );
+        }
+
+        double confirmedAbove(long long t) const {
+            if( t > last() ) return 0.0;
+            if( t < base ) t = base;
+            return confirmed.range( t - base, size() - 1 );
+        }
+
+        double confirmedBelow(long long t) const {
+            if( t < base ) return 0.0;
+            if( t > last() ) t = last();
+            return confirmed.prefix( t - base );
+        }
+
+        double pendingMaxBetween(long long first, long long second) const {
+            if( first < base ) first = base;
+            if( second > last() ) second = last();
+            return first > second ? 0.0 : pendingMax.range( first - base, second - base );
+        }
+
+        bool touch(Side s, long long& t) const {
+            long long total = empty() ? 0 : pendingMaxQty.total();
+            if( total <= 0 ) return false;
+            // Best offer is the lowest tick with quantity, best bid the highest
+            t = base + static_cast<long long>( pendingMaxQty.lowerBound( s == Side::Bid ? total : 1 ) );
+            return true;
+        }
+
+        std::size_t size() const { return confirmed.size(); }
+        long long last() const { return base + static_cast<long long>( size() ) - 1; }
+
+        // Grows the ladder, at least doubling it, when t is out of range
+        //  and the ladder is below maxTicks. Returns the end index on t's
+        //  side when t is still out of range.
+        std::size_t index(long long t) {
+            if( empty() ) {
+                base = t - InitialTicks / 2;
+                resize( InitialTicks, 0 );
+            } else if( ( t < base || t > last() ) && size() < maxTicks ) {
+                long long first = t < base ? t : base;
+                long long end = t > last() ? t + 1 : last() + 1;
+                std::size_t n;
+                long long newBase;
+                if( end - first > static_cast<long long>( maxTicks ) ) {
+                    // Out of reach: take the whole window, stretched towards t
+                    n = maxTicks;
+                    newBase = t < base ? last() + 1 - static_cast<long long>( n ) : base;
+                } else {
+                    n = size();
+                    while( static_cast<long long>( n ) < end - first ) n *= 2;
+                    // Spread the new room on both sides of the range
+                    long long room = static_cast<long long>( n ) - ( end - first );
+                    newBase = first - ( t < base ? room / 2 : 0 );
+                }
+                resize( n, static_cast<std::size_t>( base - newBase ) );
+                base = newBase;
+            }
+            if( t < base ) return 0;
+            if( t > last() ) return size() - 1;
+            return static_cast<std::size_t>( t - base );
+        }
+
+        void resize(std::size_t n, std::size_t shift) {
+            confirmed.resize( n, shift );
+            pendingMax.resize( n, shift );
+            pendingMaxQty.resize( n, shift );
+        }
+    };
+
+    static constexpr std::size_t InitialTicks = 1024;
+
+    double tickSize = 0.01;
+    Ladder bid;
+    Ladder offer;
+
+    // Far enough out to be beyond any window, and for t - base not to overflow
+    long long tick(double price) const {
+        const double bound = 1e15;
+        double t = price / tickSize;
+        return std::llround( t < -bound ? -bound : t > bound ? bound : t );
+    }
+
+    Ladder& side(Side s) { return s == Side::Bid ? bid : offer; }
+    const Ladder& side(Side s) const { return s == Side::Bid ? bid : offer; }
+};
+
+using LadderOrderTracker = BasicOrderTracker<ExposureLadder>;
+
+#endif // PRICE_LADDER_H
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Clocks.h"
+#include "ReleaseScheduler.h"
+
+// Records what reaches the session, with the time it got there
+template<typename Clock>
+struct SessionListener: public Listener {
+    std::vector<Event> sent;
+    std::vector<typename Clock::time_point> times;
+
+    void record(const Event& e) {
+        sent.push_back( e );
+        times.push_back( Clock::now() );
+    }
+
+    void OnInsertOrderRequest(int id, char side, double price, int quantity) { record( Event::insert( id, side, price, quantity ) ); }
+    void OnReplaceOrderRequest(int oldId, int newId, int deltaQuantity) { record( Event::replace( oldId, newId, deltaQuantity ) ); }
+    void OnRequestAcknowledged(int id) { record( Event::ack( id ) ); }
+    void OnRequestRejected(int id) { record( Event::reject( id ) ); }
+    void OnOrderFilled(int id, int quantityFilled) { record( Event::fill( id, quantityFilled ) ); }
+};
+
+bool sameEvent(const Listener::Event& lhs, const Listener::Event& rhs) {
+    return lhs.type == rhs.type && lhs.id == rhs.id && lhs.arg == rhs.arg && lhs.delta == rhs.delta;
+}
+
+// Releases 'count' requests through a throttle of one per 'spacing', by
+//  spinning on the clock or sleeping on a timerfd, and returns the worst
+//  lateness of a release in microseconds
+double worstLateness(bool useTimerFd, int count, std::chrono::microseconds spacing) {
+    RequestRateTracker throttle( 1, spacing );
+    SessionListener<std::chrono::steady_clock> session;
+    ReleaseScheduler scheduler( throttle, session );
+    for(int id = 1; id <= count; ++id ) scheduler.OnInsertOrderRequest( id, 'B', 10.0, 1 );
+
+    std::vector<std::chrono::steady_clock::time_point> due;
+    TimerFd timer;
+    while( scheduler.size() != 0 ) {
+        auto next = scheduler.nextRelease( std::chrono::steady_clock::now() );
+        if( useTimerFd ) {
+            timer.waitUntil( next );
+        } else {
+            while( std::chrono::steady_clock::now() < next ) {}
+        }
+        if( scheduler.poll( std::chrono::steady_clock::now() ) != 0 ) due.push_back( next );
+    }
+
+    double worst = 0.0;
+    for( std::size_t i = 0; i < due.size(); ++i ) {
+        std::chrono::duration<double, std::micro> late = session.times[i + 1] - due[i];
+        worst = std::max( worst, late.count() );
+    }
+    return worst;
+}
+
+// Test Program
+int main() {
+    using Scheduler = BasicReleaseScheduler<ManualClock>;
+    using std::chrono::milliseconds;
+    auto t0 = ManualClock::time_point( std::chrono::seconds(1) );
+    ManualClock::set( t0 );
+
+    BasicRequestRateTracker<ManualClock> throttle( 2, milliseconds(100) );
+    SessionListener<ManualClock> session;
+    Scheduler scheduler( throttle, session );
+
+    for(int id = 1; id <= 5; ++id ) scheduler.OnInsertOrderRequest( id, 'B', 10.0, 10 );
+    if( session.sent.size() != 2 || scheduler.size() != 3 || scheduler.nextRelease( t0 ) != t0 + milliseconds(100) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    // Confirmations do not wait
+    scheduler.OnRequestAcknowledged( 1 );
+    if( session.sent.size() != 3 || session.sent[2].type != Listener::Event::Type::Ack ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    // Nor do confirmations submitted as events, and they are not counted
+    //  on the throttle
+    scheduler.submit( Listener::Event::fill( 1, 4 ), ManualClock::now() );
+    if( session.sent.size() != 4 || session.sent[3].type != Listener::Event::Type::Fill || scheduler.size() != 3
+        || scheduler.nextRelease( t0 ) != t0 + milliseconds(100) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    ManualClock::set( t0 + milliseconds(99) );
+    if( scheduler.poll( ManualClock::now() ) != 0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    ManualClock::set( t0 + milliseconds(100) );
+    if( scheduler.poll( ManualClock::now() ) != 2 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    // Replaces of the same order fold into the one queued, in its place
+    scheduler.OnReplaceOrderRequest( 1, 6, 5 );
+    scheduler.OnInsertOrderRequest( 7, 'O', 11.0, 10 );
+    scheduler.OnReplaceOrderRequest( 6, 8, -2 );
+    scheduler.OnReplaceOrderRequest( 8, 9, 4 );
+    scheduler.OnReplaceOrderRequest( 2, 10, 1 );
+    if( scheduler.size() != 4 || scheduler.coalesced() != 2 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    ManualClock::set( t0 + milliseconds(1000) );
+    while( scheduler.size() != 0 ) {
+        ManualClock::set( scheduler.nextRelease( ManualClock::now() ) );
+        scheduler.poll( ManualClock::now() );
+    }
+    const Listener::Event expected[] = {
+        Listener::Event::insert(1, 'B', 10.0, 10),
+        Listener::Event::insert(2, 'B', 10.0, 10),
+        Listener::Event::ack(1),
+        Listener::Event::fill(1, 4),
+        Listener::Event::insert(3, 'B', 10.0, 10),
+        Listener::Event::insert(4, 'B', 10.0, 10),
+        Listener::Event::insert(5, 'B', 10.0, 10),
+        Listener::Event::replace(1, 9, 7),
+        Listener::Event::insert(7, 'O', 11.0, 10),
+        Listener::Event::replace(2, 10, 1)
+    };
+    if( session.sent.size() != 10 || !std::equal( session.sent.begin(), session.sent.end(), expected, sameEvent ) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    // Never more than the limit in a window, at the times they went out
+    std::vector<ManualClock::time_point> requestTimes;
+    for( std::size_t i = 0; i < session.sent.size(); ++i ) {
+        auto type = session.sent[i].type;
+        if( type == Listener::Event::Type::Insert || type == Listener::Event::Type::Replace ) requestTimes.push_back( session.times[i] );
+    }
+    for( std::size_t i = 0; i + 2 < requestTimes.size(); ++i ) {
+        if( requestTimes[i + 2] - requestTimes[i] < milliseconds(100) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
+    // On the real clock: how late each release is past its due time
+    std::cout << "busy-poll: worst lateness " << worstLateness( false, 50, std::chrono::microseconds(2000) ) << "us" << std::endl;
+    std::cout << "timerfd: worst lateness " << worstLateness( true, 50, std::chrono::microseconds(2000) ) << "us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef RELEASE_SCHEDULER_H
+#define RELEASE_SCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#include "Listener.h"
+#include "RequestRateTracker.h"
+
+// ReleaseScheduler sits on the request path in front of 'sink' (the
+//  session, or a ListenerBus): insert and replace requests go out as soon
+//  as the throttle allows them and are queued otherwise, then released in
+//  order, each at the moment the throttle allows it. Every release is
+//  counted on the throttle. Confirmations are passed straight through.
+//  A replace of an order whose replace is still queued is folded into
+//  the queued one, which keeps its place in the queue: replace(1, 2, +5)
+//  then replace(2, 3, -2) go out as replace(1, 3, +3), so a stale replace
+//  is never sent.
+//  The scheduler is driven by calling poll() when nextRelease() comes,
+//  from a busy-poll loop, or after sleeping on a TimerFd. How late a
+//  release goes out past its due time depends on the host's scheduling
+//  and timer slack, not on the scheduler; see the test program.
+template<typename Clock = std::chrono::steady_clock>
+class BasicReleaseScheduler: public Listener {
+public:
+    using TimePoint = typename Clock::time_point;
+    using Throttle = BasicRequestRateTracker<Clock>;
+
+    BasicReleaseScheduler(Throttle& t, Listener& s)
+        : throttle( t )
+        , sink( s )
+    {}
+
+    // Sends request 'e' now if the throttle allows it and nothing is
+    //  queued ahead of it, queues it otherwise. Confirmations are not
+    //  requests: they go straight to the sink and are not counted.
+    // TimeComplexity: O(1) - Expected Cost
+    void submit(const Event& e, const TimePoint& now) {
+        if( e.type != Event::Type::Insert && e.type != Event::Type::Replace ) {
+            dispatch( sink, e );
+            return;
+        }
+        if( queue.empty() && !throttle.hasThrottleHit( now ) ) {
+            release( e, now );
+            return;
+        }
+        if( e.type == Event::Type::Replace ) {
+            auto it = queuedReplaces.find( e.id );
+            if( it != queuedReplaces.end() ) {
+                Event& queued = queue[ static_cast<std::size_t>( it->second - released ) ];
+                std::uint64_t seq = it->second;
+                queuedReplaces.erase( it );
+                queued.arg = e.arg;
+                queued.delta += e.delta;
+                queuedReplaces[e.arg] = seq;
+                ++coalescedCount;
+                return;
+            }
+            queuedReplaces[e.arg] = released + queue.size();
+        }
+        queue.push_back( e );
+    }
+
+    // Releases the queued requests the throttle allows at 'now'
+    // TimeComplexity: Theta(released)
+    std::size_t poll(const TimePoint& now) {
+        std::size_t count = 0;
+        while( !queue.empty() && !throttle.hasThrottleHit( now ) ) {
+            Event e = queue.front();
+            queue.pop_front();
+            ++released;
+            if( e.type == Event::Type::Replace ) queuedReplaces.erase( e.arg );
+            release( e, now );
+            ++count;
+        }
+        return count;
+    }
+
+    // When the next queued request can go out: 'now' if it already can,
+    //  TimePoint::max() if nothing is queued
+    TimePoint nextRelease(const TimePoint& now) const {
+        if( queue.empty() ) return TimePoint::max();
+        double wait = throttle.howLongToWait( now );
+        if( wait == 0.0 ) return now;
+        TimePoint next = now + std::chrono::duration_cast<typename Clock::duration>( std::chrono::duration<double>( wait ) );
+        // The wait went through a double: round up, so that a poll at
+        //  that time does release
+        if( throttle.hasThrottleHit( next ) ) next += typename Clock::duration( 1 );
+        return next;
+    }
+
+    std::size_t size() const { return queue.size(); }
+    std::size_t coalesced() const { return coalescedCount; }
+
+    void OnInsertOrderRequest(int id, char side, double price, int quantity) {
+        submit( Event::insert( id, side, price, quantity ), Clock::now() );
+    }
+
+    void OnReplaceOrderRequest(int oldId, int newId, int deltaQuantity) {
+        submit( Event::replace( oldId, newId, deltaQuantity ), Clock::now() );
+    }
+
+    void OnRequestAcknowledged(int id) { sink.OnRequestAcknowledged( id ); }
+    void OnRequestRejected(int id) { sink.OnRequestRejected( id ); }
+    void OnOrderFilled(int id, int quantityFilled) { sink.OnOrderFilled( id, quantityFilled ); }
+private:
+    Throttle& throttle;
+    Listener& sink;
+
+    std::deque<Event> queue;
+    std::uint64_t released = 0;     // sequence number of the queue's front
+    // Queued replaces by the id they replace to, which is the id a
+    //  further replace of the same order refers to
+    std::unordered_map<int, std::uint64_t> queuedReplaces;
+    std::size_t coalescedCount = 0;
+
+    void release(const Event& e, const TimePoint& now) {
+        throttle.notifyRequests( now );
+        dispatch( sink, e );
+    }
+};
+
+using ReleaseScheduler = BasicReleaseScheduler<>;
+
+#ifdef __linux__
+// Sleeps until a steady_clock time point on a timerfd, for the
+//  scheduler's thread to block on instead of spinning. timerfd's
+//  CLOCK_MONOTONIC is steady_clock's clock on Linux.
+class TimerFd {
+public:
+    TimerFd() : fd( timerfd_create( CLOCK_MONOTONIC, 0 ) ) {}
+    ~TimerFd() { if( fd >= 0 ) close( fd ); }
+
+    TimerFd(const TimerFd&) = delete;
+    TimerFd& operator=(const TimerFd&) = delete;
+
+    bool valid() const { return fd >= 0; }
+
+    // Returns straight away if 'time' has passed
+    void waitUntil(std::chrono::steady_clock::time_point time) {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>( time.time_since_epoch() ).count();
+        if( nanos <= 0 || time <= std::chrono::steady_clock::now() ) return;
+        itimerspec spec{};
+        spec.it_value.tv_sec = static_cast<time_t>( nanos / 1000000000 );
+        spec.it_value.tv_nsec = static_cast<long>( nanos % 1000000000 );
+        if( timerfd_settime( fd, TFD_TIMER_ABSTIME, &spec, nullptr ) != 0 ) return;
+        std::uint64_t expirations;
+        while( read( fd, &expirations, sizeof(expirations) ) < 0 && errno == EINTR ) {}
+    }
+private:
+    int fd;
+};
+#endif
+
+#endif // RELEASE_SCHEDULER_H
@@ -1,149 +1,9 @@
 #include <chrono>
 #include <iostream>
+#include <thread>
 
-#include "Listener.h"
-
-class RequestRateTracker: public Listener {
-private:
-    // An utility class which can check the rate of message arrival
-    //  and inform whenever message arrival rate exceeds the specifed rate.
-    //  throtte limit is specifed by number of messages (throttleSize) and
-    //  interval(throttleInterval) during which that many messages are alllowed
-    template<typename Clock>
-    struct Throttle {
-        using TimePoint  = typename Clock::time_point;
-        using TimeDuration  = typename Clock::duration;
-
-        Throttle(
-            std::size_t thSize, 
-            const TimeDuration& thInterval
-        ): throttleSize( thSize ),
-            throttleInterval( thInterval ),
-            startOfCurrentTimeWindow( Clock::now() )
-            , lastSeenOn( startOfCurrentTimeWindow )
-            , count(0)
-        {}
-
-        void notify() {
-           lastSeenOn = Clock::now();
-           count++;
-           if( lastSeenOn > startOfCurrentTimeWindow + throttleInterval )
-                reset();
-        }
-
-        void reset() {
-            startOfCurrentTimeWindow = Clock::now();
-            lastSeenOn = startOfCurrentTimeWindow;
-            count = 0;
-        }
-
-        // Runtime: Theta(1)
-        bool isWithinThrottleLimit(const TimePoint& time) const {
-            return ( time - lastSeenOn < throttleInterval ) && ( count < throttleSize );
-        }
-
-        // Runtime: Theta(1);
-        double waitPeriod(const TimePoint& time) const {
-            double waitInterval = (time - lastSeenOn).count();
-            
-            return ( isWithinThrottleLimit(time) ?  0.0 : waitInterval );
-        }
-    private:
-       std::size_t throttleSize;
-       TimeDuration throttleInterval;
-
-       TimePoint startOfCurrentTimeWindow; 
-       TimePoint lastSeenOn; 
-       std::size_t count;
-    };
-public:
-    RequestRateTracker(
-        std::size_t throttleSize,
-        std::chrono::seconds throttleInterval
-    );
-
-    void OnInsertOrderRequest(
-        int id,
-        char side,
-        double price,
-        int quantity
-    );
-    
-    void OnReplaceOrderRequest(
-        int oldId, // The existing order to modify
-        int newId, // The new order ID to use if the modification succeeds
-        int deltaQuantity
-    );
-
-    void OnRequestAcknowledged(
-        int id
-    );
-
-    void OnRequestRejected(
-        int id
-    );
-
-    void OnOrderFilled(
-        int id,
-        int quantityFilled
-   );
-
-    bool hasThrottleHit() const { 
-        return ! throttle.isWithinThrottleLimit( std::chrono::system_clock::now() );
-    }
-
-    double howLongToWait() const {
-        return throttle.waitPeriod( std::chrono::system_clock::now() );
-    }
-private:
-    Throttle<std::chrono::system_clock> throttle;
-
-};
-
-
-RequestRateTracker::RequestRateTracker(
-    std::size_t throttleSize,
-    std::chrono::seconds throttleInterval
-) : Listener(),
-    throttle( throttleSize, throttleInterval )
-{}
-    
-
-void RequestRateTracker::OnInsertOrderRequest(
-    int id,
-    char side,
-    double price,
-    int quantity
-) {
-    throttle.notify();
-}
-    
-void RequestRateTracker::OnReplaceOrderRequest(
-    int oldId, // The existing order to modify
-    int newId, // The new order ID to use if the modification succeeds
-    int deltaQuantity
-) {
-    throttle.notify();
-}
-
-void RequestRateTracker::OnRequestAcknowledged(
-   int id
-) {
-    //NoOpe
-}
-
-void RequestRateTracker::OnRequestRejected(
-    int id
-) {
-    //NoOpe
-}
-
-void RequestRateTracker::OnOrderFilled(
-     int id,
-     int quantityFilled
-) {
-    //NoOpe
-}
+#include "Clocks.h"
+#include "RequestRateTracker.h"
 
 // test program
 int main() {
@@ -181,5 +41,98 @@ int main() {
         return -1;
     }
 
+    // A burst counts each request, and nothing else
+    RequestRateTracker burst(3, std::chrono::seconds(1));
+    const Listener::Event events[] = {
+        Listener::Event::insert(1, 'B', 10.0, 10),
+        Listener::Event::ack(1),
+        Listener::Event::fill(1, 5),
+        Listener::Event::replace(1, 2, 5)
+    };
+    burst.OnEvents( events, 4 );
+    if( burst.hasThrottleHit() ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+    burst.OnEvents( events, 1 );
+    if( ! burst.hasThrottleHit() ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+
+    // The window slides: requests leave it one by one, and the wait is the
+    //  time until the oldest one leaves
+    RequestRateTracker sliding(3, std::chrono::milliseconds(300));
+    sliding.OnInsertOrderRequest(1, 'B', 10, 10.0 );
+    std::this_thread::sleep_for( std::chrono::milliseconds(150) );
+    sliding.OnInsertOrderRequest(2, 'B', 10, 10.0 );
+    sliding.OnInsertOrderRequest(3, 'B', 10, 10.0 );
+    double wait = sliding.howLongToWait();
+    if( ! sliding.hasThrottleHit() || wait <= 0.0 || wait > 0.16 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << " due to " <<  wait << std::endl;
+        return -1;
+    }
+    std::this_thread::sleep_for( std::chrono::duration<double>( wait ) + std::chrono::milliseconds(1) );
+    if( sliding.hasThrottleHit() || sliding.howLongToWait() != 0.0 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+    // Requests 2 and 3 are still in the window
+    sliding.OnInsertOrderRequest(4, 'B', 10, 10.0 );
+    wait = sliding.howLongToWait();
+    if( ! sliding.hasThrottleHit() || wait <= 0.05 || wait > 0.16 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << " due to " <<  wait << std::endl;
+        return -1;
+    }
+
+    // Driven by a manual clock, the limit is exact
+    BasicRequestRateTracker<ManualClock> manual(2, std::chrono::milliseconds(100));
+    ManualClock::set( ManualClock::time_point( std::chrono::seconds(1) ) );
+    manual.OnInsertOrderRequest(1, 'B', 10, 10.0 );
+    ManualClock::advance( std::chrono::milliseconds(40) );
+    manual.OnReplaceOrderRequest(1, 2, 5 );
+    if( ! manual.hasThrottleHit() || manual.howLongToWait() != 0.06 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << " due to " <<  manual.howLongToWait() << std::endl;
+        return -1;
+    }
+    ManualClock::advance( std::chrono::milliseconds(60) );
+    if( manual.hasThrottleHit() || manual.howLongToWait() != 0.0 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+
+    // Event timestamps passed in: no clock is read
+    auto t0 = ManualClock::time_point( std::chrono::seconds(5) );
+    BasicRequestRateTracker<ManualClock> stamped(2, std::chrono::milliseconds(100));
+    stamped.notifyRequests( t0, 2 );
+    if( ! stamped.hasThrottleHit( t0 + std::chrono::milliseconds(99) )
+        || stamped.hasThrottleHit( t0 + std::chrono::milliseconds(100) )
+        || stamped.howLongToWait( t0 + std::chrono::milliseconds(75) ) != 0.025 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+
+    // The cheaper clocks behave like steady_clock as far as throttling goes
+    BasicRequestRateTracker<TscClock> tsc(1, std::chrono::seconds(10));
+    tsc.OnInsertOrderRequest(1, 'B', 10, 10.0 );
+    if( ! tsc.hasThrottleHit() || tsc.howLongToWait() <= 9.0 ) {
+        std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+        return -1;
+    }
+    {
+        CoarseClock::Updater updater( std::chrono::milliseconds(1) );
+        BasicRequestRateTracker<CoarseClock> coarse(1, std::chrono::milliseconds(20));
+        coarse.OnInsertOrderRequest(1, 'B', 10, 10.0 );
+        if( ! coarse.hasThrottleHit() ) {
+            std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+            return -1;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds(30) );
+        if( coarse.hasThrottleHit() ) {
+            std::cout <<"Test Case Failed at " <<  __LINE__ << std::endl;
+            return -1;
+        }
+    }
+
     std::cout << "Tests Passed!" << std::endl;
 }
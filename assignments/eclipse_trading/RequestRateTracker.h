@@ -0,0 +1,225 @@
+#ifndef REQUEST_RATE_TRACKER_H
+#define REQUEST_RATE_TRACKER_H
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "Listener.h"
+
+// Counts insert and replace requests against a limit of throttleSize
+//  requests per throttleInterval, on Clock (see Clocks.h for cheaper
+//  clocks than steady_clock). The callbacks read the clock once each;
+//  the overloads taking a time point read none, for callers which already
+//  have the time of the event.
+template<typename Clock = std::chrono::steady_clock>
+class BasicRequestRateTracker: public Listener {
+private:
+    // An utility class which can check the rate of message arrival
+    //  and inform whenever message arrival rate exceeds the specifed rate.
+    //  throtte limit is specifed by number of messages (throttleSize) and
+    //  interval(throttleInterval) during which that many messages are alllowed
+    //  The window slides: arrival times of the last throttleSize messages
+    //  are kept in a ring buffer (allocated once, on construction), and the
+    //  limit is reached while the oldest of them is still within
+    //  throttleInterval of now.
+    template<typename ThrottleClock>
+    struct Throttle {
+        using TimePoint  = typename ThrottleClock::time_point;
+        using TimeDuration  = typename ThrottleClock::duration;
+
+        Throttle(
+            std::size_t thSize, 
+            const TimeDuration& thInterval
+        ): throttleSize( thSize ),
+            throttleInterval( thInterval ),
+            arrivals( thSize )
+        {}
+
+        // Runtime: Theta(1)
+        void notify() {
+           notify( 1 );
+        }
+
+        // n messages arriving together
+        // Runtime: Theta(min(n, throttleSize))
+        void notify(std::size_t n) {
+           if( throttleSize == 0 ) return;
+           notify( n, ThrottleClock::now() );
+        }
+
+        // n messages arriving together at 'now'
+        // Pre-Condition: now is not earlier than the previous arrival
+        // Runtime: Theta(min(n, throttleSize))
+        void notify(std::size_t n, const TimePoint& now) {
+           if( throttleSize == 0 ) return;
+           if( n > throttleSize ) n = throttleSize;
+           for( std::size_t i = 0; i < n; ++i ) {
+               arrivals[next] = now;
+               next = ( next + 1 == throttleSize ) ? 0 : next + 1;
+           }
+           count = ( count + n > throttleSize ) ? throttleSize : count + n;
+        }
+
+        // True while fewer than throttleSize messages arrived within
+        //  throttleInterval before 'time', i.e. one more message would not
+        //  exceed the limit
+        // Runtime: Theta(1)
+        bool isWithinThrottleLimit(const TimePoint& time) const {
+            if( count < throttleSize ) return true;
+            return throttleSize != 0 && time - oldest() >= throttleInterval;
+        }
+
+        // Seconds until the oldest message in the window leaves it, 0.0 if
+        //  a message could be sent right away
+        // Runtime: Theta(1);
+        double waitPeriod(const TimePoint& time) const {
+            if( isWithinThrottleLimit(time) ) return 0.0;
+            if( throttleSize == 0 ) return std::numeric_limits<double>::infinity();
+            return std::chrono::duration<double>( oldest() + throttleInterval - time ).count();
+        }
+    private:
+       std::size_t throttleSize;
+       TimeDuration throttleInterval;
+
+       std::vector<TimePoint> arrivals;
+       std::size_t next = 0;    // slot of the next arrival, which holds the oldest once full
+       std::size_t count = 0;
+
+       const TimePoint& oldest() const { return arrivals[next]; }
+    };
+public:
+    using TimePoint = typename Clock::time_point;
+
+    BasicRequestRateTracker(
+        std::size_t throttleSize,
+        typename Clock::duration throttleInterval
+    );
+
+    void OnInsertOrderRequest(
+        int id,
+        char side,
+        double price,
+        int quantity
+    );
+    
+    void OnReplaceOrderRequest(
+        int oldId, // The existing order to modify
+        int newId, // The new order ID to use if the modification succeeds
+        int deltaQuantity
+    );
+
+    void OnRequestAcknowledged(
+        int id
+    );
+
+    void OnRequestRejected(
+        int id
+    );
+
+    void OnOrderFilled(
+        int id,
+        int quantityFilled
+   );
+
+    // Counts the requests of a burst with a single clock read
+    void OnEvents(
+        const Event* events,
+        std::size_t count
+    );
+
+    // n insert or replace requests sent at 'time'
+    void notifyRequests(
+        const TimePoint& time,
+        std::size_t n = 1
+    ) {
+        throttle.notify( n, time );
+    }
+
+    bool hasThrottleHit() const { 
+        return hasThrottleHit( Clock::now() );
+    }
+
+    bool hasThrottleHit(const TimePoint& time) const {
+        return ! throttle.isWithinThrottleLimit( time );
+    }
+
+    double howLongToWait() const {
+        return howLongToWait( Clock::now() );
+    }
+
+    double howLongToWait(const TimePoint& time) const {
+        return throttle.waitPeriod( time );
+    }
+private:
+    Throttle<Clock> throttle;
+
+};
+
+using RequestRateTracker = BasicRequestRateTracker<>;
+
+
+template<typename Clock>
+inline BasicRequestRateTracker<Clock>::BasicRequestRateTracker(
+    std::size_t throttleSize,
+    typename Clock::duration throttleInterval
+) : Listener(),
+    throttle( throttleSize, throttleInterval )
+{}
+    
+
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnInsertOrderRequest(
+    int id,
+    char side,
+    double price,
+    int quantity
+) {
+    throttle.notify();
+}
+    
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnReplaceOrderRequest(
+    int oldId, // The existing order to modify
+    int newId, // The new order ID to use if the modification succeeds
+    int deltaQuantity
+) {
+    throttle.notify();
+}
+
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnRequestAcknowledged(
+   int id
+) {
+    //NoOpe
+}
+
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnRequestRejected(
+    int id
+) {
+    //NoOpe
+}
+
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnOrderFilled(
+     int id,
+     int quantityFilled
+) {
+    //NoOpe
+}
+
+template<typename Clock>
+inline void BasicRequestRateTracker<Clock>::OnEvents(
+    const Event* events,
+    std::size_t count
+) {
+    std::size_t requests = 0;
+    for( std::size_t i = 0; i < count; ++i ) {
+        if( events[i].type == Event::Type::Insert || events[i].type == Event::Type::Replace ) ++requests;
+    }
+    if( requests != 0 ) throttle.notify( requests );
+}
+
+#endif // REQUEST_RATE_TRACKER_H
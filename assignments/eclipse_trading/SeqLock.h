@@ -0,0 +1,63 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// SeqLock publishes a value written by a single thread to any number of
+//  reader threads. The writer never waits: it bumps the sequence to odd,
+//  writes the value and bumps the sequence back to even. Readers copy the
+//  value and retry if the sequence was odd or changed meanwhile, so they
+//  never block the writer and only retry when they overlap a store.
+//  The value is held in relaxed atomic words, so a torn copy is never a
+//  data race, just a copy which gets thrown away.
+//  On x86 neither side issues a locked instruction or a full fence.
+template<typename T>
+class SeqLock {
+    static_assert( std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable value" );
+public:
+    SeqLock() { store( T() ); }
+    explicit SeqLock(const T& value) { store( value ); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Writer only
+    // TimeComplexity: Theta(sizeof(T))
+    void store(const T& value) {
+        std::uint64_t buffer[Words] = {};
+        std::memcpy( buffer, &value, sizeof(T) );
+
+        unsigned s = seq.load( std::memory_order_relaxed );
+        seq.store( s + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        for( std::size_t i = 0; i < Words; ++i ) words[i].store( buffer[i], std::memory_order_relaxed );
+        seq.store( s + 2, std::memory_order_release );
+    }
+
+    // Any thread. Returns a value which was stored as a whole
+    // TimeComplexity: Theta(sizeof(T)), retried while overlapping a store
+    T load() const {
+        std::uint64_t buffer[Words];
+        unsigned before, after;
+        do {
+            before = seq.load( std::memory_order_acquire );
+            for( std::size_t i = 0; i < Words; ++i ) buffer[i] = words[i].load( std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_acquire );
+            after = seq.load( std::memory_order_relaxed );
+        } while( ( before & 1 ) != 0 || before != after );
+
+        T value;
+        std::memcpy( &value, buffer, sizeof(T) );
+        return value;
+    }
+private:
+    static constexpr std::size_t Words = ( sizeof(T) + sizeof(std::uint64_t) - 1 ) / sizeof(std::uint64_t);
+
+    std::atomic<unsigned> seq{0};
+    std::atomic<std::uint64_t> words[Words];
+};
+
+#endif // SEQ_LOCK_H
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Clocks.h"
+#include "RequestRateTracker.h"
+#include "SharedThrottle.h"
+
+using std::chrono::milliseconds;
+
+// Runs f(thread index) on n threads at once, returns the elapsed seconds
+template<typename F>
+double runThreads(int n, F f) {
+    std::vector<std::thread> threads;
+    std::atomic<bool> go( false );
+    for(int t = 0; t < n; ++t ) {
+        threads.emplace_back( [&go, &f, t]() {
+            while( !go.load() ) {}
+            f( t );
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store( true );
+    for(auto& t: threads ) t.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Test Program: exact behaviour on a manual clock, the limit holding under
+//  contention, then throughput against a mutex around RequestRateTracker
+//  Usage: SharedThrottle [max threads]
+int main(int argc, char* argv[]) {
+    auto t0 = ManualClock::time_point( std::chrono::seconds(1) );
+
+    // burst 1: the limit is paced, one request every 25ms
+    BasicSharedThrottle<ManualClock> paced( 4, milliseconds(100) );
+    if( paced.tryAcquire( t0 ) != 0.0 || paced.tryAcquire( t0 ) != 0.025
+        || paced.tryAcquire( t0 + milliseconds(10) ) != 0.015 || paced.tryAcquire( t0 + milliseconds(25) ) != 0.0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    // burst 3 of 4: three back to back, the next two 50ms apart
+    BasicSharedThrottle<ManualClock> bursty( 4, milliseconds(100), 3 );
+    for(int i = 0; i < 3; ++i ) {
+        if( bursty.tryAcquire( t0 ) != 0.0 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+    }
+    if( bursty.tryAcquire( t0 ) != 0.05 || bursty.howLongToWait( t0 + milliseconds(20) ) != 0.03
+        || bursty.tryAcquire( t0 + milliseconds(50) ) != 0.0 || bursty.tryAcquire( t0 + milliseconds(99) ) == 0.0
+        || bursty.tryAcquire( t0 + milliseconds(100) ) != 0.0 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    BasicSharedThrottle<ManualClock> closed( 0, milliseconds(100) );
+    if( closed.tryAcquire( t0 ) != std::numeric_limits<double>::infinity() ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    int maxThreads = argc > 1 ? std::stoi( argv[1] ) : 8;
+
+    {
+        // Every window of 'interval' holds at most 'limit' of the requests
+        //  admitted, whichever threads they came from
+        const std::size_t limit = 2000;
+        const auto interval = std::chrono::milliseconds(20);
+        SharedThrottle shared( limit, interval, 500 );
+        std::vector<std::vector<std::int64_t>> admitted( maxThreads );
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        runThreads( maxThreads, [&](int t) {
+            for( ;; ) {
+                auto now = std::chrono::steady_clock::now();
+                if( now >= end ) break;
+                if( shared.tryAcquire( now ) == 0.0 ) admitted[t].push_back( now.time_since_epoch().count() );
+            }
+        });
+        std::vector<std::int64_t> times;
+        for(auto& a: admitted ) times.insert( times.end(), a.begin(), a.end() );
+        std::sort( times.begin(), times.end() );
+        std::int64_t window = std::chrono::duration_cast<std::chrono::steady_clock::duration>( interval ).count();
+        for( std::size_t i = 0; i + limit < times.size(); ++i ) {
+            if( times[i + limit] - times[i] < window ) {
+                std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+                return -1;
+            }
+        }
+        // and the limiter is not stingy: it paces 1501 requests per 20ms,
+        //  so over 300ms it admits well over half that many
+        if( times.size() < 1501 * 8 ) {
+            std::cout << "Test Case Failed at " << __LINE__ << " due to " << times.size() << std::endl;
+            return -1;
+        }
+    }
+
+    // Throughput, with a limit high enough never to deny
+    const int perThread = 2000000;
+    for(int n = 1; n <= maxThreads; n *= 2 ) {
+        SharedThrottle shared( 1u << 30, std::chrono::seconds(1) );
+        double lockFree = runThreads( n, [&](int) {
+            for(int i = 0; i < perThread; ++i ) shared.tryAcquire();
+        });
+
+        std::mutex m;
+        RequestRateTracker tracker( 1u << 22, std::chrono::seconds(1) );
+        double locked = runThreads( n, [&](int) {
+            for(int i = 0; i < perThread; ++i ) {
+                std::lock_guard<std::mutex> lock( m );
+                if( !tracker.hasThrottleHit() ) tracker.OnInsertOrderRequest( i, 'B', 10.0, 1 );
+            }
+        });
+
+        std::cout << n << " threads: SharedThrottle " << static_cast<long long>( n * perThread / lockFree )
+                  << " req/s, mutex + RequestRateTracker " << static_cast<long long>( n * perThread / locked )
+                  << " req/s" << std::endl;
+    }
+    return 0;
+}
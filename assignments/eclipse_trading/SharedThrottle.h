@@ -0,0 +1,82 @@
+#ifndef SHARED_THROTTLE_H
+#define SHARED_THROTTLE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "CacheLine.h"
+
+// SharedThrottle is a rate limit shared by any number of threads without a
+//  lock: its whole state is one atomic theoretical arrival time (TAT), as
+//  in GCRA, and a request is admitted by a compare-and-swap on it.
+//  It allows at most 'limit' requests in any window of 'interval', like
+//  RequestRateTracker, with up to 'burst' of them back to back. The
+//  remaining limit - burst + 1 are paced evenly over the interval, so a
+//  burst is paid for in sustained rate: burst = 1 paces the whole limit,
+//  burst = limit allows one full burst per interval.
+//  (Plain GCRA, with limit back to back and limit per interval sustained,
+//  can let up to 2 * limit - 1 requests into one window.)
+template<typename Clock = std::chrono::steady_clock>
+class BasicSharedThrottle {
+public:
+    using TimePoint = typename Clock::time_point;
+    using Duration = typename Clock::duration;
+
+    // Pre-Condition: 1 <= burst <= limit, unless limit is 0
+    BasicSharedThrottle(std::size_t limit, Duration interval, std::size_t burst = 1)
+        : emission( limit == 0 ? 0 : divideUp( interval.count(), static_cast<Rep>( limit - burst + 1 ) ) )
+        , tolerance( limit == 0 ? 0 : emission * static_cast<Rep>( burst - 1 ) )
+        , blocked( limit == 0 )
+        , tat( std::numeric_limits<Rep>::min() / 2 )
+    {}
+
+    BasicSharedThrottle(const BasicSharedThrottle&) = delete;
+    BasicSharedThrottle& operator=(const BasicSharedThrottle&) = delete;
+
+    // Admits a request at 'now' if it keeps within the limit. Returns 0.0
+    //  if it was admitted, otherwise the seconds until one would be, and
+    //  records nothing.
+    // TimeComplexity: Theta(1), retried while other threads win the CAS
+    double tryAcquire(const TimePoint& now) {
+        if( blocked ) return std::numeric_limits<double>::infinity();
+        Rep time = now.time_since_epoch().count();
+        Rep expected = tat.value.load( std::memory_order_relaxed );
+        for( ;; ) {
+            if( time < expected - tolerance ) return seconds( expected - tolerance - time );
+            Rep next = ( expected > time ? expected : time ) + emission;
+            if( tat.value.compare_exchange_weak( expected, next, std::memory_order_relaxed ) ) return 0.0;
+        }
+    }
+
+    double tryAcquire() { return tryAcquire( Clock::now() ); }
+
+    // Seconds until a request would be admitted, 0.0 if right away
+    // TimeComplexity: Theta(1)
+    double howLongToWait(const TimePoint& now) const {
+        if( blocked ) return std::numeric_limits<double>::infinity();
+        Rep wait = tat.value.load( std::memory_order_relaxed ) - tolerance - now.time_since_epoch().count();
+        return wait > 0 ? seconds( wait ) : 0.0;
+    }
+
+    double howLongToWait() const { return howLongToWait( Clock::now() ); }
+private:
+    using Rep = typename Duration::rep;
+
+    static Rep divideUp(Rep lhs, Rep rhs) { return ( lhs + rhs - 1 ) / rhs; }
+
+    static double seconds(Rep d) { return std::chrono::duration<double>( Duration( d ) ).count(); }
+
+    const Rep emission;     // spacing of the paced requests
+    const Rep tolerance;    // how far ahead of the pace a burst may run
+    const bool blocked;
+
+    // Away from whatever the owner keeps next to the throttle
+    CacheLinePadded<std::atomic<Rep>> tat;
+};
+
+using SharedThrottle = BasicSharedThrottle<>;
+
+#endif // SHARED_THROTTLE_H
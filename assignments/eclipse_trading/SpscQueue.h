@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "CacheLine.h"
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+//  thread. Each side keeps a cached copy of the other side's index, so the
+//  shared indices are only read when the cached one says the queue looks
+//  full (producer) or empty (consumer).
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : items( roundUpToPowerOfTwo( capacity ) )
+        , mask( items.size() - 1 )
+    {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. Returns false if the queue is full
+    // TimeComplexity: Theta(1)
+    bool tryPush(const T& item) {
+        std::size_t t = tail.load( std::memory_order_relaxed );
+        if( t - cachedHead == items.size() ) {
+            cachedHead = head.load( std::memory_order_acquire );
+            if( t - cachedHead == items.size() ) return false;
+        }
+        items[ t & mask ] = item;
+        tail.store( t + 1, std::memory_order_release );
+        return true;
+    }
+
+    // Consumer only. Calls f(item) for up to 'max' queued items and
+    //  releases their slots in one go. Returns the number of items consumed
+    // TimeComplexity: Theta(N) for N items consumed
+    template<typename F>
+    std::size_t consume(F f, std::size_t max) {
+        std::size_t h = head.load( std::memory_order_relaxed );
+        if( h == cachedTail ) {
+            cachedTail = tail.load( std::memory_order_acquire );
+            if( h == cachedTail ) return 0;
+        }
+        std::size_t n = cachedTail - h;
+        if( n > max ) n = max;
+        for( std::size_t i = 0; i < n; ++i ) f( items[ ( h + i ) & mask ] );
+        head.store( h + n, std::memory_order_release );
+        return n;
+    }
+
+    std::size_t capacity() const { return items.size(); }
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t p = 1;
+        while( p < n ) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> items;
+    std::size_t mask;
+
+    // Producer and consumer sides are kept on separate cache lines
+    char padding0[CacheLineSize];
+    std::atomic<std::size_t> tail{0};
+    std::size_t cachedHead = 0;
+    char padding1[CacheLineSize];
+    std::atomic<std::size_t> head{0};
+    std::size_t cachedTail = 0;
+    char padding2[CacheLineSize];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Clocks.h"
+#include "RequestRateTracker.h"
+#include "TieredRateLimiter.h"
+
+using Limiter = BasicTieredRateLimiter<ManualClock>;
+using Tracker = BasicRequestRateTracker<ManualClock>;
+using std::chrono::milliseconds;
+
+// Test Program
+int main() {
+    ManualClock::set( ManualClock::time_point( std::chrono::seconds(1) ) );
+    Limiter limiter{
+        { RequestClass::Any, 3, milliseconds(100) },
+        { RequestClass::Any, 5, milliseconds(1000) },
+        { RequestClass::Replace, 2, milliseconds(10000) }
+    };
+
+    limiter.OnInsertOrderRequest(1, 'B', 10.0, 10);
+    limiter.OnReplaceOrderRequest(1, 2, 5);
+    if( limiter.hasThrottleHit( RequestClass::Insert ) || limiter.hasThrottleHit( RequestClass::Replace ) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    limiter.OnInsertOrderRequest(3, 'B', 10.0, 10);
+    // The 100ms tier is full for both classes
+    if( !limiter.hasThrottleHit( RequestClass::Insert ) || limiter.howLongToWait( RequestClass::Insert ) != 0.1 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << " due to " << limiter.howLongToWait( RequestClass::Insert ) << std::endl;
+        return -1;
+    }
+    ManualClock::advance( milliseconds(100) );
+    limiter.OnReplaceOrderRequest(3, 4, 5);
+    // Inserts are still allowed, replaces are held by their own tier
+    if( limiter.hasThrottleHit( RequestClass::Insert ) || limiter.howLongToWait( RequestClass::Replace ) != 9.9 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << " due to " << limiter.howLongToWait( RequestClass::Replace ) << std::endl;
+        return -1;
+    }
+    // The wait is the longest over the tiers: the 1s tier fills up
+    limiter.OnInsertOrderRequest(5, 'B', 10.0, 10);
+    ManualClock::advance( milliseconds(100) );
+    if( !limiter.hasThrottleHit( RequestClass::Insert ) || limiter.howLongToWait( RequestClass::Insert ) != 0.8 ) {
+        std::cout << "Test Case Failed at " << __LINE__ << " due to " << limiter.howLongToWait( RequestClass::Insert ) << std::endl;
+        return -1;
+    }
+
+    // A burst counts each class on its own tiers
+    Limiter burst{ { RequestClass::Insert, 2, milliseconds(100) }, { RequestClass::Replace, 3, milliseconds(100) } };
+    const Listener::Event events[] = {
+        Listener::Event::insert(1, 'B', 10.0, 10),
+        Listener::Event::ack(1),
+        Listener::Event::replace(1, 2, 5),
+        Listener::Event::replace(2, 3, 5),
+        Listener::Event::insert(4, 'O', 11.0, 10)
+    };
+    burst.OnEvents( events, 5 );
+    if( !burst.hasThrottleHit( RequestClass::Insert ) || burst.hasThrottleHit( RequestClass::Replace )
+        || !burst.hasThrottleHit( RequestClass::Any ) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    Limiter closed{ { RequestClass::Replace, 0, milliseconds(100) } };
+    if( !closed.hasThrottleHit( RequestClass::Replace ) || closed.hasThrottleHit( RequestClass::Insert )
+        || closed.howLongToWait( RequestClass::Replace ) != std::numeric_limits<double>::infinity() ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+
+    // Random traffic against one single-window tracker per tier
+    Limiter tiered{
+        { RequestClass::Any, 50, milliseconds(100) },
+        { RequestClass::Any, 500, milliseconds(1000) },
+        { RequestClass::Insert, 10000, milliseconds(60000) },
+        { RequestClass::Replace, 3000, milliseconds(60000) }
+    };
+    Tracker any100( 50, milliseconds(100) ), any1000( 500, milliseconds(1000) );
+    Tracker inserts( 10000, milliseconds(60000) ), replaces( 3000, milliseconds(60000) );
+    std::mt19937 gen( 3 );
+    auto now = ManualClock::now();
+    for(int i = 0; i < 2000000; ++i ) {
+        now += std::chrono::microseconds( gen() % 400 );
+        bool insert = gen() % 4 != 0;
+        RequestClass c = insert ? RequestClass::Insert : RequestClass::Replace;
+        Tracker& own = insert ? inserts : replaces;
+        bool expected = !any100.hasThrottleHit( now ) && !any1000.hasThrottleHit( now ) && !own.hasThrottleHit( now );
+        double wait = std::max( std::max( any100.howLongToWait( now ), any1000.howLongToWait( now ) ), own.howLongToWait( now ) );
+        if( tiered.howLongToWait( c, now ) != wait || tiered.tryAcquire( c, now ) != expected ) {
+            std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+            return -1;
+        }
+        if( expected ) {
+            any100.notifyRequests( now );
+            any1000.notifyRequests( now );
+            own.notifyRequests( now );
+        }
+    }
+
+    // Cost of a check and record over the four tiers
+    const int requests = 20000000;
+    auto start = std::chrono::steady_clock::now();
+    long passed = 0;
+    for(int i = 0; i < requests; ++i ) {
+        now += std::chrono::microseconds( 100 );
+        passed += tiered.tryAcquire( i % 4 ? RequestClass::Insert : RequestClass::Replace, now );
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "4 tiers: " << static_cast<long long>( requests / elapsed.count() ) << " tryAcquire/s, "
+              << passed << " allowed" << std::endl;
+    return 0;
+}
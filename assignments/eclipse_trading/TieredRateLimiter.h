@@ -0,0 +1,155 @@
+#ifndef TIERED_RATE_LIMITER_H
+#define TIERED_RATE_LIMITER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+#include "Listener.h"
+
+// The kinds of request a tier counts: inserts, replaces, or both
+enum class RequestClass: unsigned char {
+    Insert = 1,
+    Replace = 2,
+    Any = 3
+};
+
+// Enforces several sliding window limits at once, as exchanges do, e.g.
+//    TieredRateLimiter limiter{
+//        { RequestClass::Any, 50, std::chrono::milliseconds(100) },
+//        { RequestClass::Any, 500, std::chrono::seconds(1) },
+//        { RequestClass::Insert, 10000, std::chrono::minutes(1) },
+//        { RequestClass::Replace, 2000, std::chrono::minutes(1) }
+//    };
+//  Each tier is an exact sliding window like RequestRateTracker's: a ring
+//  of the arrival times of its last 'limit' requests. The rings of all
+//  the tiers share one pool, allocated on construction, and the tiers'
+//  bookkeeping is a small flat array, so a request or a query is one pass
+//  over the tiers with no allocation.
+template<typename Clock = std::chrono::steady_clock>
+class BasicTieredRateLimiter: public Listener {
+public:
+    using TimePoint = typename Clock::time_point;
+    using Duration = typename Clock::duration;
+
+    struct Tier {
+        RequestClass requests;
+        std::size_t limit;
+        Duration interval;
+    };
+
+    BasicTieredRateLimiter(std::initializer_list<Tier> tiers)
+        : BasicTieredRateLimiter( std::vector<Tier>( tiers ) )
+    {}
+
+    explicit BasicTieredRateLimiter(const std::vector<Tier>& tiers) {
+        std::size_t pool = 0;
+        for(auto& t: tiers ) {
+            states.push_back( State{ t.interval, pool, t.limit, 0, 0, static_cast<unsigned char>( t.requests ) } );
+            pool += t.limit;
+        }
+        arrivals.resize( pool );
+    }
+
+    // n requests of class c sent at 'time'
+    // Pre-Condition: time is not earlier than the previous request
+    // TimeComplexity: Theta(tiers), for n = 1
+    void notify(RequestClass c, const TimePoint& time, std::size_t n = 1) {
+        for(auto& s: states ) {
+            if( ( s.requests & static_cast<unsigned char>( c ) ) == 0 || s.limit == 0 ) continue;
+            std::size_t k = n < s.limit ? n : s.limit;
+            for( std::size_t i = 0; i < k; ++i ) {
+                arrivals[s.offset + s.next] = time;
+                s.next = ( s.next + 1 == s.limit ) ? 0 : s.next + 1;
+            }
+            s.count = ( s.count + k > s.limit ) ? s.limit : s.count + k;
+        }
+    }
+
+    // Whether one more request of class c would stay within every tier
+    // TimeComplexity: Theta(tiers)
+    bool isWithinLimit(RequestClass c, const TimePoint& time) const {
+        for(auto& s: states ) {
+            if( ( s.requests & static_cast<unsigned char>( c ) ) != 0 && !within( s, time ) ) return false;
+        }
+        return true;
+    }
+
+    // Seconds until one more request of class c would stay within every
+    //  tier, 0.0 if it would right away
+    // TimeComplexity: Theta(tiers)
+    double howLongToWait(RequestClass c, const TimePoint& time) const {
+        Duration wait = Duration::zero();
+        for(auto& s: states ) {
+            if( ( s.requests & static_cast<unsigned char>( c ) ) == 0 || within( s, time ) ) continue;
+            if( s.limit == 0 ) return std::numeric_limits<double>::infinity();
+            Duration w = oldest( s ) + s.interval - time;
+            if( w > wait ) wait = w;
+        }
+        return std::chrono::duration<double>( wait ).count();
+    }
+
+    // Records a request of class c if it stays within every tier
+    // TimeComplexity: Theta(tiers)
+    bool tryAcquire(RequestClass c, const TimePoint& time) {
+        if( !isWithinLimit( c, time ) ) return false;
+        notify( c, time );
+        return true;
+    }
+
+    bool hasThrottleHit(RequestClass c) const { return !isWithinLimit( c, Clock::now() ); }
+    double howLongToWait(RequestClass c) const { return howLongToWait( c, Clock::now() ); }
+
+    void OnInsertOrderRequest(int, char, double, int) {
+        notify( RequestClass::Insert, Clock::now() );
+    }
+
+    void OnReplaceOrderRequest(int, int, int) {
+        notify( RequestClass::Replace, Clock::now() );
+    }
+
+    void OnRequestAcknowledged(int) {}
+    void OnRequestRejected(int) {}
+    void OnOrderFilled(int, int) {}
+
+    // Counts the requests of a burst with a single clock read
+    void OnEvents(const Event* events, std::size_t count) {
+        std::size_t inserts = 0, replaces = 0;
+        for( std::size_t i = 0; i < count; ++i ) {
+            if( events[i].type == Event::Type::Insert ) ++inserts;
+            else if( events[i].type == Event::Type::Replace ) ++replaces;
+        }
+        if( inserts == 0 && replaces == 0 ) return;
+        TimePoint now = Clock::now();
+        if( inserts != 0 ) notify( RequestClass::Insert, now, inserts );
+        if( replaces != 0 ) notify( RequestClass::Replace, now, replaces );
+    }
+
+    std::size_t tiers() const { return states.size(); }
+private:
+    struct State {
+        Duration interval;
+        std::size_t offset;     // of the tier's ring in the pool
+        std::size_t limit;
+        std::size_t next;       // slot of the next arrival, which holds the oldest once full
+        std::size_t count;
+        unsigned char requests; // RequestClass bits counted
+    };
+
+    std::vector<State> states;
+    std::vector<TimePoint> arrivals;
+
+    const TimePoint& oldest(const State& s) const { return arrivals[s.offset + s.next]; }
+
+    bool within(const State& s, const TimePoint& time) const {
+        if( s.count < s.limit ) return true;
+        return s.limit != 0 && time - oldest( s ) >= s.interval;
+    }
+};
+
+using TieredRateLimiter = BasicTieredRateLimiter<>;
+
+#endif // TIERED_RATE_LIMITER_H
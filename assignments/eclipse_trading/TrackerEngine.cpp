@@ -0,0 +1,202 @@
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TrackerEngine.h"
+
+// A scripted callback for one of the listeners
+struct Step {
+    enum class Type : char { Insert, Replace, Ack, Reject, Fill };
+    Type type;
+    std::size_t listener;
+    int id;
+    int arg;
+    int delta;
+    char side;
+    double price;
+};
+
+void play(Listener& l, const Step& s) {
+    switch( s.type ) {
+        case Step::Type::Insert: l.OnInsertOrderRequest( s.id, s.side, s.price, s.arg ); break;
+        case Step::Type::Replace: l.OnReplaceOrderRequest( s.id, s.arg, s.delta ); break;
+        case Step::Type::Ack: l.OnRequestAcknowledged( s.id ); break;
+        case Step::Type::Reject: l.OnRequestRejected( s.id ); break;
+        case Step::Type::Fill: l.OnOrderFilled( s.id, s.arg ); break;
+    }
+}
+
+// Builds a script in which the orders of all listeners are interleaved.
+//  Every order goes through one of the following lifecycles:
+//   insert, ack, partial fill, replace(+5), ack, fill the rest
+//   insert, ack, partial fill, replace(-2), reject, fill the rest
+//   insert, reject
+//  Orders left open at the end of the script stay in the book.
+std::vector<Step> makeScript(std::size_t listeners, std::size_t steps, unsigned seed) {
+    std::mt19937 random( seed );
+    std::vector<std::vector<Step>> pending( listeners );
+    std::vector<Step> script;
+    script.reserve( steps );
+    int nextId = 1;
+
+    while( script.size() < steps ) {
+        std::size_t l = random() % listeners;
+        auto& queue = pending[l];
+        if( queue.empty() ) {
+            int id = nextId;
+            nextId += 2;
+            char side = random() % 2 ? 'B' : 'O';
+            // Cents, which binary fractions cannot hold exactly
+            double price = 50.0 + static_cast<int>( random() % 100 ) * 0.01;
+            int qty = 10;
+            queue.push_back( Step{ Step::Type::Insert, l, id, qty, 0, side, price } );
+            switch( random() % 5 ) {
+                case 0:
+                    queue.push_back( Step{ Step::Type::Reject, l, id, 0, 0, 0, 0.0 } );
+                    break;
+                case 1:
+                case 2:
+                    queue.push_back( Step{ Step::Type::Ack, l, id, 0, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Fill, l, id, 4, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Replace, l, id, id + 1, 5, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Ack, l, id + 1, 0, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Fill, l, id + 1, qty - 4 + 5, 0, 0, 0.0 } );
+                    break;
+                default:
+                    queue.push_back( Step{ Step::Type::Ack, l, id, 0, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Fill, l, id, 4, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Replace, l, id, id + 1, -2, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Reject, l, id + 1, 0, 0, 0, 0.0 } );
+                    queue.push_back( Step{ Step::Type::Fill, l, id, qty - 4, 0, 0, 0.0 } );
+                    break;
+            }
+            std::reverse( queue.begin(), queue.end() );
+        }
+        script.push_back( queue.back() );
+        queue.pop_back();
+    }
+    return script;
+}
+
+// Values within 'tolerance' of each other, quantities equal
+bool near(const Exposure& lhs, const Exposure& rhs, double tolerance) {
+    return lhs.netFilledQuantity == rhs.netFilledQuantity
+        && std::fabs( lhs.confirmedBidValue - rhs.confirmedBidValue ) <= tolerance
+        && std::fabs( lhs.confirmedOfferValue - rhs.confirmedOfferValue ) <= tolerance
+        && std::fabs( lhs.pendingBidMinValue - rhs.pendingBidMinValue ) <= tolerance
+        && std::fabs( lhs.pendingBidMaxValue - rhs.pendingBidMaxValue ) <= tolerance
+        && std::fabs( lhs.pendingOfferMinValue - rhs.pendingOfferMinValue ) <= tolerance
+        && std::fabs( lhs.pendingOfferMaxValue - rhs.pendingOfferMaxValue ) <= tolerance;
+}
+
+std::ostream& operator<<(std::ostream& out, const Exposure& e) {
+    out << "NFQ: " << e.netFilledQuantity
+        << ", COV-Bid: " << e.confirmedBidValue
+        << ", COV-Offer: " << e.confirmedOfferValue
+        << ", POV-Bid-Min: " << e.pendingBidMinValue
+        << ", POV-Bid-Max: " << e.pendingBidMaxValue
+        << ", POV-Offer-Min: " << e.pendingOfferMinValue
+        << ", POV-Offer-Max: " << e.pendingOfferMaxValue;
+    return out;
+}
+
+std::string symbolName(std::size_t i) { return "SYM" + std::to_string( i ); }
+std::string accountName(std::size_t i) { return "ACC" + std::to_string( i ); }
+
+// Aggregates must match single threaded trackers fed with the same script,
+//  up to the rounding of prices to a millionth
+int testAggregates() {
+    const std::size_t symbolCount = 5, accountCount = 3;
+    const double tolerance = 1e-6 * symbolCount * accountCount;
+    TrackerEngine::Config config;
+    config.shards = 3;
+    config.queueCapacity = 64; // small enough for the producer to wait on workers
+    TrackerEngine engine( config );
+
+    std::vector<Listener*> listeners;
+    std::vector<OrderTracker> reference( symbolCount * accountCount );
+    for( std::size_t s = 0; s < symbolCount; ++s ) {
+        for( std::size_t a = 0; a < accountCount; ++a ) {
+            listeners.push_back( &engine.listener( symbolName( s ), accountName( a ) ) );
+        }
+    }
+    engine.start();
+
+    auto script = makeScript( listeners.size(), 200000, 7 );
+    for(auto& step: script ) {
+        play( *listeners[step.listener], step );
+        play( reference[step.listener], step );
+    }
+    engine.flush();
+
+    Exposure firm;
+    for( std::size_t s = 0; s < symbolCount; ++s ) {
+        Exposure symbol;
+        for( std::size_t a = 0; a < accountCount; ++a ) symbol += Exposure::of( reference[ s * accountCount + a ] );
+        if( !near( engine.symbolExposure( symbolName( s ) ), symbol, tolerance ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << " for " << symbolName( s ) << std::endl;
+            return -1;
+        }
+        firm += symbol;
+    }
+    for( std::size_t a = 0; a < accountCount; ++a ) {
+        Exposure account;
+        for( std::size_t s = 0; s < symbolCount; ++s ) account += Exposure::of( reference[ s * accountCount + a ] );
+        if( !near( engine.accountExposure( accountName( a ) ), account, tolerance ) ) {
+            std::cout << "Test Case Failed at " << __LINE__ << " for " << accountName( a ) << std::endl;
+            return -1;
+        }
+    }
+    if( !near( engine.firmExposure(), firm, tolerance ) ) {
+        std::cout << "Test Case Failed at " << __LINE__ << std::endl;
+        return -1;
+    }
+    std::cout << "Firm: " << engine.firmExposure() << std::endl;
+    engine.stop();
+    return 0;
+}
+
+// Measures how many callbacks per second a single feeding thread can push
+//  through the engine
+void benchmark(std::size_t shards, std::size_t symbolCount, std::size_t accountCount, std::size_t steps) {
+    TrackerEngine::Config config;
+    config.shards = shards;
+    TrackerEngine engine( config );
+
+    std::vector<Listener*> listeners;
+    for( std::size_t s = 0; s < symbolCount; ++s ) {
+        for( std::size_t a = 0; a < accountCount; ++a ) {
+            listeners.push_back( &engine.listener( symbolName( s ), accountName( a ) ) );
+        }
+    }
+    auto script = makeScript( listeners.size(), steps, 11 );
+    engine.start();
+
+    auto start = std::chrono::steady_clock::now();
+    for(auto& step: script ) play( *listeners[step.listener], step );
+    engine.flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    engine.stop();
+
+    std::cout << shards << " shards, " << listeners.size() << " (symbol, account) pairs: "
+              << static_cast<long long>( steps / elapsed.count() ) << " callbacks/s" << std::endl;
+}
+
+// Test Program: checks the aggregates and then measures the throughput
+//  for 1, 2, ... up to the given number of shards
+//  Usage: tracker_engine [max shards] [callbacks]
+int main(int argc, char** argv) {
+    if( testAggregates() != 0 ) return -1;
+
+    std::size_t maxShards = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : TrackerEngine::defaultShards();
+    std::size_t steps = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 5000000;
+    for( std::size_t shards = 1; shards <= maxShards; shards *= 2 ) {
+        benchmark( shards, 1000, 10, steps );
+    }
+    return 0;
+}
@@ -0,0 +1,408 @@
+#ifndef TRACKER_ENGINE_H
+#define TRACKER_ENGINE_H
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "CacheLine.h"
+#include "Listener.h"
+#include "OrderTracker.h"
+#include "SeqLock.h"
+#include "SpscQueue.h"
+
+// TrackerEngine tracks orders of many (symbol, account) pairs. Each pair
+//  gets its own Listener, whose callbacks are queued to the worker thread
+//  owning the pair and applied there to the pair's OrderTracker.
+//  Workers maintain per symbol, per account and firm-wide aggregates
+//  incrementally: every pair's tracker carries an accumulator which adds
+//  the change made by each notification straight to the aggregates of the
+//  worker. Every worker keeps its own partial aggregates (written by that
+//  worker alone, so workers never contend on a cache line) and publishes
+//  the ones it touched once per batch of queued events; a query adds up
+//  one partial per worker.
+//  Aggregated values are kept in fixed point, in millionths: a value is
+//  the order's price rounded to a millionth times an integer quantity, so
+//  adding changes up is exact and an aggregate never drifts from the sum
+//  of its pairs, however long the session, where summed doubles would.
+//  Values must stay within +/-9.2e12.
+//  Assumptions:
+//   * pairs are registered (listener) before start
+//   * all callbacks, flush and stop are called from the same thread, as
+//     with a single Listener: each shard is fed through a single producer
+//     queue
+//   * queries may be made from any thread; each shard's partial is a
+//     consistent snapshot as of the end of a batch, but partials of
+//     different shards may be as of slightly different points in the feed
+//     while events are flowing
+class TrackerEngine {
+public:
+    struct Config {
+        std::size_t shards = defaultShards();
+        std::size_t queueCapacity = 1 << 16;   // events per shard
+        std::size_t orderWindow = 64;          // per pair, see OrderStore
+    };
+
+    TrackerEngine()
+        : TrackerEngine( Config() )
+    {}
+
+    explicit TrackerEngine(const Config& c)
+        : config(c)
+    {
+        if( config.shards == 0 ) config.shards = 1;
+        for( std::size_t i = 0; i < config.shards; ++i ) {
+            shards.emplace_back( new Shard( config.queueCapacity ) );
+        }
+    }
+
+    TrackerEngine(const TrackerEngine&) = delete;
+    TrackerEngine& operator=(const TrackerEngine&) = delete;
+
+    ~TrackerEngine() { stop(); }
+
+    // Listener for the orders of 'account' in 'symbol'. Pairs are spread
+    //  over the shards in the order they are registered.
+    // Pre-Condition: engine is not started
+    // TimeComplexity: O(1) - Amortized Cost
+    Listener& listener(const std::string& symbol, const std::string& account) {
+        assert( !started.load( std::memory_order_relaxed ) );
+        std::uint32_t s = indexOf( symbols, symbol );
+        std::uint32_t a = indexOf( accounts, account );
+        auto key = std::make_pair( s, a );
+        auto iter = pairs.find( key );
+        if( iter != pairs.end() ) return *iter->second;
+
+        Shard& shard = *shards[ pairs.size() % shards.size() ];
+        auto local = static_cast<std::uint32_t>( shard.pairs.size() );
+        shard.pairs.emplace_back( config.orderWindow, s, a );
+        std::unique_ptr<PairListener> l( new PairListener( shard, local ) );
+        return *( pairs[key] = std::move( l ) );
+    }
+
+    // Queries made after start() returns see the aggregates
+    void start() {
+        if( started.load( std::memory_order_relaxed ) ) return;
+        running.store( true, std::memory_order_release );
+        for(auto& shard: shards ) {
+            shard->symbols.reset( new PublishedExposure[ symbols.size() ] );
+            shard->accounts.reset( new PublishedExposure[ accounts.size() ] );
+            shard->dirty.reserve( 2 * BatchSize );
+            for(auto& state: shard->pairs ) {
+                state.tracker.metric<ExposureFeed>().bind(
+                    shard->symbols[ state.symbol ].value, shard->accounts[ state.account ].value, shard->firm.value );
+            }
+        }
+        // Publishes the partials to the query threads
+        started.store( true, std::memory_order_release );
+        for(auto& shard: shards ) {
+            Shard* s = shard.get();
+            workers.emplace_back( [this, s]() { run( *s ); } );
+        }
+    }
+
+    // Applies every queued event and stops the workers
+    void stop() {
+        if( !running.load( std::memory_order_acquire ) ) return;
+        running.store( false, std::memory_order_release );
+        for(auto& w: workers ) w.join();
+        workers.clear();
+    }
+
+    // Waits until every event queued so far has been applied
+    void flush() {
+        for(auto& shard: shards ) {
+            while( shard->applied.value.load( std::memory_order_acquire ) != shard->pushed ) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // TimeComplexity: Theta(S) for S shards
+    Exposure symbolExposure(const std::string& symbol) const {
+        auto iter = symbols.find( symbol );
+        return iter == symbols.end() ? Exposure() : sum( &Shard::symbols, iter->second );
+    }
+
+    // TimeComplexity: Theta(S) for S shards
+    Exposure accountExposure(const std::string& account) const {
+        auto iter = accounts.find( account );
+        return iter == accounts.end() ? Exposure() : sum( &Shard::accounts, iter->second );
+    }
+
+    // TimeComplexity: Theta(S) for S shards
+    Exposure firmExposure() const {
+        Exposure total;
+        if( !started.load( std::memory_order_acquire ) ) return total;
+        for(auto& shard: shards ) total += shard->firm.load();
+        return total;
+    }
+
+    std::size_t shardCount() const { return shards.size(); }
+
+    static std::size_t defaultShards() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 1;
+    }
+private:
+    struct QueuedEvent {
+        std::uint32_t pair;     // index of the pair within the shard
+        Listener::Event event;
+    };
+
+    static constexpr std::size_t BatchSize = 256;
+
+    // Exposure in fixed point, in units of 1 / Scale
+    struct FixedExposure {
+        static constexpr double Scale = 1e6;
+
+        long long netFilledQuantity = 0;
+        long long confirmedBidValue = 0;
+        long long confirmedOfferValue = 0;
+        long long pendingBidMinValue = 0;
+        long long pendingBidMaxValue = 0;
+        long long pendingOfferMinValue = 0;
+        long long pendingOfferMaxValue = 0;
+
+        Exposure exposure() const {
+            Exposure e;
+            e.netFilledQuantity = netFilledQuantity;
+            e.confirmedBidValue = confirmedBidValue / Scale;
+            e.confirmedOfferValue = confirmedOfferValue / Scale;
+            e.pendingBidMinValue = pendingBidMinValue / Scale;
+            e.pendingBidMaxValue = pendingBidMaxValue / Scale;
+            e.pendingOfferMinValue = pendingOfferMinValue / Scale;
+            e.pendingOfferMaxValue = pendingOfferMaxValue / Scale;
+            return e;
+        }
+    };
+
+    // Accumulator adding the fixed point change of every notification to
+    //  the partials of its pair's symbol and account and to the firm-wide
+    //  partial. It follows NetFilledQuantity, ConfirmedOrderValue and
+    //  PendingOrderValue, with the price rounded to a millionth.
+    struct ExposureFeed: NoOpAccumulator {
+        void bind(FixedExposure& symbol, FixedExposure& account, FixedExposure& firm) {
+            targets[0] = &symbol;
+            targets[1] = &account;
+            targets[2] = &firm;
+        }
+
+        void notifyInsert(const OrderInfo& order) {
+            add( pick( order.side, &FixedExposure::pendingBidMaxValue, &FixedExposure::pendingOfferMaxValue ), value( order, order.quantity ) );
+        }
+
+        void notifyAck(const OrderInfo& order) {
+            long long v = value( order, order.quantity );
+            add( pick( order.side, &FixedExposure::confirmedBidValue, &FixedExposure::confirmedOfferValue ), v );
+            add( pick( order.side, &FixedExposure::pendingBidMinValue, &FixedExposure::pendingOfferMinValue ), v );
+        }
+
+        void notifyReject(const OrderInfo& order) {
+            add( pick( order.side, &FixedExposure::pendingBidMaxValue, &FixedExposure::pendingOfferMaxValue ), -value( order, order.quantity ) );
+        }
+
+        // A pending change may or may not happen
+        void notifyReplace(const OrderInfo& order, int deltaQty) {
+            long long v = value( order, deltaQty );
+            add( v > 0 ? max( order.side ) : min( order.side ), v );
+        }
+
+        // A pending change did happen
+        void notifyReplaceAck(const OrderInfo& order, int deltaQty) {
+            long long v = value( order, deltaQty );
+            add( pick( order.side, &FixedExposure::confirmedBidValue, &FixedExposure::confirmedOfferValue ), v );
+            add( v > 0 ? min( order.side ) : max( order.side ), v );
+        }
+
+        // A pending change did not happen
+        void notifyReplaceReject(const OrderInfo& order, int deltaQty) {
+            long long v = value( order, deltaQty );
+            add( v > 0 ? max( order.side ) : min( order.side ), -v );
+        }
+
+        void notifyFill(const OrderInfo& order, int qtyFilled) {
+            long long v = value( order, qtyFilled );
+            add( &FixedExposure::netFilledQuantity, order.side == Side::Bid ? qtyFilled : -qtyFilled );
+            add( pick( order.side, &FixedExposure::confirmedBidValue, &FixedExposure::confirmedOfferValue ), -v );
+            add( min( order.side ), -v );
+            add( max( order.side ), -v );
+        }
+    private:
+        using Field = long long FixedExposure::*;
+
+        FixedExposure* targets[3] = {};
+
+        static long long value(const OrderInfo& order, int quantity) {
+            return std::llround( order.price * FixedExposure::Scale ) * quantity;
+        }
+
+        static Field pick(Side side, Field bid, Field offer) { return side == Side::Bid ? bid : offer; }
+        static Field min(Side side) { return pick( side, &FixedExposure::pendingBidMinValue, &FixedExposure::pendingOfferMinValue ); }
+        static Field max(Side side) { return pick( side, &FixedExposure::pendingBidMaxValue, &FixedExposure::pendingOfferMaxValue ); }
+
+        void add(Field field, long long delta) {
+            targets[0]->*field += delta;
+            targets[1]->*field += delta;
+            targets[2]->*field += delta;
+        }
+    };
+
+    using PairTracker = BasicOrderTracker<ExposureFeed>;
+
+    // Exposure added up by a single worker and published to any thread
+    struct PublishedExposure {
+        FixedExposure value;    // writer only
+        bool dirty = false;     // writer only: changed since last published
+
+        void publish() { published.store( value ); }
+
+        Exposure load() const { return published.load().exposure(); }
+    private:
+        SeqLock<FixedExposure> published;
+    };
+
+    struct PairState {
+        PairState(std::size_t window, std::uint32_t s, std::uint32_t a)
+            : tracker(window)
+            , symbol(s)
+            , account(a)
+        {}
+
+        PairTracker tracker;
+        std::uint32_t symbol;
+        std::uint32_t account;
+    };
+
+    struct Shard {
+        explicit Shard(std::size_t queueCapacity)
+            : queue(queueCapacity)
+        {}
+
+        SpscQueue<QueuedEvent> queue;
+        std::size_t pushed = 0;             // producer only
+        CacheLinePadded<std::atomic<std::size_t>> applied{ 0 };
+
+        // Worker only, once started
+        std::deque<PairState> pairs;
+        std::unique_ptr<PublishedExposure[]> symbols;
+        std::unique_ptr<PublishedExposure[]> accounts;
+        PublishedExposure firm;
+        std::vector<PublishedExposure*> dirty;
+
+        void touch(PublishedExposure& partial) {
+            if( partial.dirty ) return;
+            partial.dirty = true;
+            dirty.push_back( &partial );
+        }
+
+        // Publishes the partials changed by the last batch
+        void publish() {
+            for(PublishedExposure* partial: dirty ) {
+                partial->publish();
+                partial->dirty = false;
+            }
+            dirty.clear();
+            firm.publish();
+        }
+    };
+
+    // Listener handed out for a single pair: callbacks are queued as is
+    class PairListener: public Listener {
+    public:
+        PairListener(Shard& s, std::uint32_t p)
+            : shard(s)
+            , pair(p)
+        {}
+
+        void OnInsertOrderRequest(int id, char side, double price, int quantity) {
+            push( Event::insert( id, side, price, quantity ) );
+        }
+
+        void OnReplaceOrderRequest(int oldId, int newId, int deltaQuantity) {
+            push( Event::replace( oldId, newId, deltaQuantity ) );
+        }
+
+        void OnRequestAcknowledged(int id) {
+            push( Event::ack( id ) );
+        }
+
+        void OnRequestRejected(int id) {
+            push( Event::reject( id ) );
+        }
+
+        void OnOrderFilled(int id, int quantityFilled) {
+            push( Event::fill( id, quantityFilled ) );
+        }
+    private:
+        Shard& shard;
+        std::uint32_t pair;
+
+        // Waits for the worker while the queue is full
+        void push(const Event& e) {
+            QueuedEvent queued{ pair, e };
+            while( !shard.queue.tryPush( queued ) ) std::this_thread::yield();
+            ++shard.pushed;
+        }
+    };
+
+    struct PairKeyHash {
+        std::size_t operator()(const std::pair<std::uint32_t, std::uint32_t>& k) const {
+            return ( static_cast<std::size_t>( k.first ) << 32 ) ^ k.second;
+        }
+    };
+
+    Config config;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{false};
+    std::atomic<bool> started{false};
+
+    std::unordered_map<std::string, std::uint32_t> symbols;
+    std::unordered_map<std::string, std::uint32_t> accounts;
+    std::unordered_map<std::pair<std::uint32_t, std::uint32_t>, std::unique_ptr<PairListener>, PairKeyHash> pairs;
+
+    static std::uint32_t indexOf(std::unordered_map<std::string, std::uint32_t>& names, const std::string& name) {
+        return names.insert( std::make_pair( name, static_cast<std::uint32_t>( names.size() ) ) ).first->second;
+    }
+
+    Exposure sum(std::unique_ptr<PublishedExposure[]> Shard::*partials, std::uint32_t index) const {
+        Exposure total;
+        if( !started.load( std::memory_order_acquire ) ) return total;
+        for(auto& shard: shards ) total += ( (*shard).*partials )[index].load();
+        return total;
+    }
+
+    static void apply(Shard& shard, const QueuedEvent& e) {
+        PairState& state = shard.pairs[e.pair];
+        state.tracker.apply( e.event );
+        shard.touch( shard.symbols[ state.symbol ] );
+        shard.touch( shard.accounts[ state.account ] );
+    }
+
+    void run(Shard& shard) {
+        std::size_t idle = 0;
+        while( true ) {
+            // Events pushed before stop are visible once stop is seen
+            bool stopping = !running.load( std::memory_order_acquire );
+            std::size_t n = shard.queue.consume( [&shard](const QueuedEvent& e) { apply( shard, e ); }, BatchSize );
+            if( n != 0 ) {
+                shard.publish();
+                shard.applied.value.store( shard.applied.value.load( std::memory_order_relaxed ) + n, std::memory_order_release );
+                idle = 0;
+                continue;
+            }
+            if( stopping ) break;
+            if( ++idle > 64 ) std::this_thread::yield();
+        }
+    }
+};
+
+#endif // TRACKER_ENGINE_H
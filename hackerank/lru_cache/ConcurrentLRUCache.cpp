@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <numeric>
+
+#include "ConcurrentLRUCache.h"
+using namespace std;
+
+// Outcome of runConcurrently: the wall time from the start to the last
+//  join, in seconds, and the sum of what the threads returned
+struct ThreadRun {
+    double seconds;
+    long total;
+};
+
+// Runs body(t) for every t in [0, n) on its own thread. The threads are
+//  started together once all of them exist; until then they yield, so
+//  that runs with more threads than cores measure the cache, not the
+//  spinning.
+template<typename F>
+ThreadRun runConcurrently(int n, F body) {
+    vector<thread> threads;
+    vector<long> results( n );
+    atomic<int> ready( 0 );
+    atomic<bool> go( false );
+    for(int t = 0; t < n; ++t ) {
+        threads.emplace_back( [&, t]() {
+            ready.fetch_add( 1 );
+            while( !go.load() ) this_thread::yield();
+            results[t] = body( t );
+        });
+    }
+    while( ready.load() != n ) this_thread::yield();
+    auto start = chrono::steady_clock::now();
+    go.store( true );
+    for(auto& t: threads ) t.join();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return ThreadRun{ elapsed.count(), accumulate( results.begin(), results.end(), 0L ) };
+}
+
+// Test Program: a single unbuffered shard is exactly LRUCache; many
+//  threads on many shards never see a value which was not set, then
+//  throughput from 1 to N threads
+//  Usage: ConcurrentLRUCache [max threads]
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? stoi( argv[1] ) : 8;
+
+    {
+        ConcurrentLRUCache concurrent( 100, 1 );
+        LRUCache plain( 100 );
+        mt19937 gen( 5 );
+        for(int i = 0; i < 200000; ++i ) {
+            int key = static_cast<int>( gen() % 300 );
+            if( gen() % 3 == 0 ) {
+                concurrent.set( key, i );
+                plain.set( key, i );
+            } else if( concurrent.get( key ) != plain.get( key ) ) {
+                cout << "Test Case Failed at " << __LINE__ << endl;
+                return -1;
+            }
+        }
+    }
+
+    for(bool buffered: { false, true } ) {
+        const int capacity = 1000;
+        ConcurrentLRUCache cache( capacity, 16, buffered );
+        // Each thread counts the values it got which were never set
+        ThreadRun run = runConcurrently( maxThreads, [&](int t) {
+            mt19937 gen( t );
+            long wrong = 0;
+            for(int i = 0; i < 200000; ++i ) {
+                int key = static_cast<int>( gen() % 3000 );
+                if( gen() % 4 == 0 ) {
+                    cache.set( key, key * 3 );
+                } else {
+                    int value = cache.get( key );
+                    if( value != -1 && value != key * 3 ) ++wrong;
+                }
+            }
+            return wrong;
+        });
+        if( run.total != 0 || cache.size() > capacity + cache.shardCount() ) {
+            cout << "Test Case Failed at " << __LINE__ << endl;
+            return -1;
+        }
+        // A hot key survives a scan when it is hit, buffered or not
+        ConcurrentLRUCache small( 64, 1, buffered );
+        for(int key = 0; key < 64; ++key ) small.set( key, key );
+        for(int i = 0; i < 64 * ConcurrentLRUCache::RecencyBatch; ++i ) small.get( 0 );
+        for(int key = 100; key < 132; ++key ) small.set( key, key );
+        if( small.get( 0 ) != 0 || small.get( 1 ) != -1 ) {
+            cout << "Test Case Failed at " << __LINE__ << endl;
+            return -1;
+        }
+        // A buffered hit is applied by the thread's next set at the latest
+        ConcurrentLRUCache one( 64, 1, buffered );
+        for(int key = 0; key < 64; ++key ) one.set( key, key );
+        one.get( 0 );
+        one.set( 100, 100 );
+        if( one.get( 0 ) != 0 || one.get( 1 ) != -1 ) {
+            cout << "Test Case Failed at " << __LINE__ << endl;
+            return -1;
+        }
+    }
+
+    // Reference data lookups: 95% gets on a working set that fits, so
+    //  every get must hit
+    const int capacity = 100000, workingSet = capacity / 2, perThread = 2000000;
+    struct Config { const char* name; int shards; bool buffered; };
+    const Config configs[] = {
+        { "1 shard", 1, false },
+        { "16 shards", 16, false },
+        { "16 shards, buffered recency", 16, true }
+    };
+    for(auto& config: configs ) {
+        for(int n = 1; n <= maxThreads; n *= 2 ) {
+            ConcurrentLRUCache cache( capacity, config.shards, config.buffered );
+            for(int key = 0; key < workingSet; ++key ) cache.set( key, key );
+            ThreadRun run = runConcurrently( n, [&](int t) {
+                mt19937 gen( t );
+                long misses = 0;
+                for(int i = 0; i < perThread; ++i ) {
+                    int key = static_cast<int>( gen() % workingSet );
+                    if( i % 20 == 0 ) cache.set( key, key );
+                    else if( cache.get( key ) != key ) ++misses;
+                }
+                return misses;
+            });
+            if( run.total != 0 ) {
+                cout << "Test Case Failed at " << __LINE__ << " with " << run.total << " misses" << endl;
+                return -1;
+            }
+            cout << config.name << ", " << n << " threads: "
+                 << static_cast<long long>( n * perThread / run.seconds ) << " ops/s" << endl;
+        }
+    }
+    return 0;
+}
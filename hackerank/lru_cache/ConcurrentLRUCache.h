@@ -0,0 +1,167 @@
+#ifndef CONCURRENT_LRU_CACHE_H
+#define CONCURRENT_LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <pthread.h>
+
+#include "LRUCache.h"
+
+// ConcurrentLRUCache spreads keys over independently locked LRUCache
+//  shards (a power of two, up to MaxShards), so that threads working on
+//  different keys rarely meet on a lock. Each shard sits on its own cache
+//  lines. Eviction is LRU within a shard; each shard holds
+//  capacity / shards entries (rounded up).
+//  Shards are guarded by a reader-writer lock (pthread, as C++11 has no
+//  shared mutex). A plain get reorders the shard's list, so it takes the
+//  lock exclusively, like set.
+//  With buffered recency, a hit does not reorder the list: get looks the
+//  key up under the shared lock, so gets on a shard run side by side, and
+//  records it in the calling thread's buffer for that shard. Once the
+//  buffer holds RecencyBatch hits, get tries for the exclusive lock and
+//  applies them if it gets it right away; otherwise the buffer keeps the
+//  latest RecencyBatch hits and tries again on the next one. A set by the
+//  thread applies the buffer as well, under the lock it takes anyway.
+//  Recency becomes approximate: an entry hit on a thread whose buffer has
+//  not been applied yet may be evicted as if it had not been.
+class ConcurrentLRUCache {
+public:
+    static const int MaxShards = 64;
+    static const int RecencyBatch = 16;
+
+    explicit ConcurrentLRUCache(int capacity, int shardCount = 16, bool bufferedRecency = false)
+        : buffered( bufferedRecency )
+    {
+        int n = 1;
+        while( n < shardCount && n < MaxShards ) n <<= 1;
+        shards.reset( new Shard[n] );
+        mask = static_cast<std::uint32_t>( n - 1 );
+        int perShard = capacity > 0 ? ( capacity + n - 1 ) / n : 0;
+        for(int i = 0; i < n; ++i ) shards[i].cache = LRUCache( perShard );
+    }
+
+    ConcurrentLRUCache(const ConcurrentLRUCache&) = delete;
+    ConcurrentLRUCache& operator=(const ConcurrentLRUCache&) = delete;
+
+    // Value of key, -1 if it is not cached
+    // TimeComplexity: O(1) - Expected Cost
+    int get(int key) {
+        std::uint32_t s = shardOf( key );
+        Shard& shard = shards[s];
+        if( !buffered ) {
+            WriteGuard guard( shard.lock );
+            return shard.cache.get( key );
+        }
+
+        int value;
+        {
+            ReadGuard guard( shard.lock );
+            value = shard.cache.peek( key );
+        }
+        if( value != -1 ) {
+            RecencyBuffer& b = recencyBuffer( s, shard );
+            b.keys[ b.next++ % RecencyBatch ] = key;
+            if( b.count < RecencyBatch ) ++b.count;
+            if( b.count == RecencyBatch && pthread_rwlock_trywrlock( &shard.lock ) == 0 ) {
+                apply( shard, b );
+                pthread_rwlock_unlock( &shard.lock );
+            }
+        }
+        return value;
+    }
+
+    // TimeComplexity: O(1) - Expected Cost, plus the thread's buffered hits
+    void set(int key, int value) {
+        std::uint32_t s = shardOf( key );
+        Shard& shard = shards[s];
+        WriteGuard guard( shard.lock );
+        if( buffered ) apply( shard, recencyBuffer( s, shard ) );
+        shard.cache.set( key, value );
+    }
+
+    // Not a snapshot: shards are counted one after the other
+    int size() {
+        int total = 0;
+        for( std::uint32_t i = 0; i <= mask; ++i ) {
+            ReadGuard guard( shards[i].lock );
+            total += shards[i].cache.size();
+        }
+        return total;
+    }
+
+    int shardCount() const { return static_cast<int>( mask + 1 ); }
+private:
+    static const std::size_t CacheLine = 64;
+
+    // Lock and cache are kept off the lines of the neighbouring shards
+    struct Shard {
+        char padBefore[CacheLine];
+        pthread_rwlock_t lock;
+        LRUCache cache{ 0 };
+        char padAfter[CacheLine];
+
+        Shard() { pthread_rwlock_init( &lock, nullptr ); }
+        ~Shard() { pthread_rwlock_destroy( &lock ); }
+    };
+
+    struct ReadGuard {
+        explicit ReadGuard(pthread_rwlock_t& l) : lock( l ) { pthread_rwlock_rdlock( &lock ); }
+        ~ReadGuard() { pthread_rwlock_unlock( &lock ); }
+        pthread_rwlock_t& lock;
+    };
+
+    struct WriteGuard {
+        explicit WriteGuard(pthread_rwlock_t& l) : lock( l ) { pthread_rwlock_wrlock( &lock ); }
+        ~WriteGuard() { pthread_rwlock_unlock( &lock ); }
+        pthread_rwlock_t& lock;
+    };
+
+    // The latest hits, on a ring: keys[(next - count + i) % RecencyBatch]
+    //  for i in [0, count), oldest first
+    struct RecencyBuffer {
+        const Shard* owner;
+        unsigned next;
+        int count;
+        int keys[RecencyBatch];
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    std::uint32_t mask;
+    bool buffered;
+
+    // A different mix from LRUCache's, whose buckets come from the high
+    //  bits of a multiplicative hash, so that keys of one shard still
+    //  spread over its buckets
+    std::uint32_t shardOf(int key) const {
+        std::uint32_t h = static_cast<std::uint32_t>( key );
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h & mask;
+    }
+
+    // The calling thread's buffer for shard s. It is shared with any other
+    //  cache the thread uses; 'owner' tells whose hits it holds, and hits
+    //  of another shard are dropped when it changes hands.
+    static RecencyBuffer& recencyBuffer(std::uint32_t s, const Shard& shard) {
+        static thread_local RecencyBuffer buffers[MaxShards] = {};
+        RecencyBuffer& b = buffers[s];
+        if( b.owner != &shard ) {
+            b.owner = &shard;
+            b.next = 0;
+            b.count = 0;
+        }
+        return b;
+    }
+
+    // Pre-Condition: the shard's lock is held exclusively
+    static void apply(Shard& shard, RecencyBuffer& b) {
+        for(int i = 0; i < b.count; ++i ) shard.cache.touch( b.keys[ ( b.next - b.count + i ) % RecencyBatch ] );
+        b.count = 0;
+    }
+};
+
+#endif // CONCURRENT_LRU_CACHE_H
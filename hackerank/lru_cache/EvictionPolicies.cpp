@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "EvictionPolicies.h"
+using namespace std;
+
+// Keys drawn from a Zipf distribution over [0, n)
+class Zipf {
+public:
+    Zipf(int n, double s) : cdf( n ) {
+        double sum = 0.0;
+        for(int i = 0; i < n; ++i ) cdf[i] = ( sum += 1.0 / pow( i + 1, s ) );
+        for(auto& c: cdf ) c /= sum;
+    }
+
+    template<typename Gen>
+    int operator()(Gen& gen) {
+        double u = uniform_real_distribution<double>( 0.0, 1.0 )( gen );
+        return static_cast<int>( lower_bound( cdf.begin(), cdf.end(), u ) - cdf.begin() );
+    }
+private:
+    vector<double> cdf;
+};
+
+struct Result {
+    double hitRatio;
+    double opsPerSecond;
+};
+
+// Look-aside use: get, and set on a miss
+template<typename Cache>
+Result replay(int capacity, const vector<int>& trace) {
+    Cache cache( capacity );
+    long hits = 0;
+    auto start = chrono::steady_clock::now();
+    for(int key: trace ) {
+        if( cache.get( key ) != -1 ) ++hits;
+        else cache.set( key, key );
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return Result{ static_cast<double>( hits ) / trace.size(), trace.size() / elapsed.count() };
+}
+
+// A hit returns the last value set, and the cache never overflows
+template<typename Cache>
+bool consistent(int capacity) {
+    Cache cache( capacity );
+    unordered_map<int, int> last;
+    mt19937 gen( 17 );
+    for(int i = 0; i < 200000; ++i ) {
+        int key = static_cast<int>( gen() % ( capacity * 3 + 3 ) );
+        if( gen() % 3 == 0 ) {
+            cache.set( key, i );
+            last[key] = i;
+        } else {
+            int value = cache.get( key );
+            if( value != -1 && value != last[key] ) return false;
+        }
+        if( cache.size() > capacity ) return false;
+    }
+    return true;
+}
+
+template<typename Cache>
+void report(const char* name, int capacity, const vector<vector<int>>& traces) {
+    cout << name;
+    for(auto& trace: traces ) {
+        Result r = replay<Cache>( capacity, trace );
+        cout << "\t" << static_cast<int>( r.hitRatio * 1000 ) / 10.0 << "% "
+             << static_cast<long long>( r.opsPerSecond / 1e6 ) << "M/s";
+    }
+    cout << endl;
+}
+
+// Test Program: every policy keeps values right; the scan resistant ones
+//  beat LRU on a scan-heavy trace; then hit ratio and throughput of each
+//  on a skewed, a scan-heavy and a looping trace
+int main() {
+    for(int capacity: { 0, 1, 2, 5, 10, 64, 1000 } ) {
+        if( !consistent<LRUCache>( capacity ) || !consistent<ClockCache>( capacity )
+            || !consistent<SlruCache>( capacity ) || !consistent<S3FifoCache>( capacity ) ) {
+            cout << "Test Case Failed at " << __LINE__ << " for capacity " << capacity << endl;
+            return -1;
+        }
+    }
+
+    // CLOCK spares a referenced entry once
+    ClockCache clock( 2 );
+    clock.set( 1, 1 );
+    clock.set( 2, 2 );
+    clock.get( 1 );
+    clock.set( 3, 3 );
+    if( clock.peek( 1 ) != 1 || clock.peek( 2 ) != -1 ) {
+        cout << "Test Case Failed at " << __LINE__ << endl;
+        return -1;
+    }
+
+    const int capacity = 10000, keys = 1000000, length = 5000000;
+    mt19937 gen( 23 );
+    Zipf zipf( keys, 0.9 );
+
+    vector<int> skewed, scans, loop;
+    for(int i = 0; i < length; ++i ) skewed.push_back( zipf( gen ) );
+    // Zipf traffic interleaved with scans of keys never seen again
+    int fresh = keys;
+    for(int i = 0; i < length; ++i ) {
+        if( ( i / 20000 ) % 2 ) scans.push_back( fresh++ );
+        else scans.push_back( zipf( gen ) );
+    }
+    // A loop slightly larger than the cache: LRU's worst case
+    for(int i = 0; i < length; ++i ) loop.push_back( i % ( capacity + capacity / 10 ) );
+
+    double lru = replay<LRUCache>( capacity, scans ).hitRatio;
+    if( replay<SlruCache>( capacity, scans ).hitRatio <= lru || replay<S3FifoCache>( capacity, scans ).hitRatio <= lru ) {
+        cout << "Test Case Failed at " << __LINE__ << endl;
+        return -1;
+    }
+
+    vector<vector<int>> traces{ skewed, scans, loop };
+    cout << "policy\tzipf 0.9\tzipf + scans\tloop" << endl;
+    report<LRUCache>( "LRU", capacity, traces );
+    report<ClockCache>( "CLOCK", capacity, traces );
+    report<SlruCache>( "SLRU", capacity, traces );
+    report<S3FifoCache>( "S3-FIFO", capacity, traces );
+    return 0;
+}
@@ -0,0 +1,205 @@
+#ifndef EVICTION_POLICIES_H
+#define EVICTION_POLICIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LRUCache.h"
+
+// CLOCK (second chance): a hit only sets the slot's reference bit. To
+//  evict, the hand sweeps the slots in order, clearing set bits, and
+//  takes the first slot whose bit was clear.
+class ClockPolicy {
+public:
+    explicit ClockPolicy(std::uint32_t capacity)
+        : referenced( capacity, 0 )
+        , hand( 0 )
+    {}
+
+    void inserted(std::uint32_t slot, int) { referenced[slot] = 0; }
+
+    void hit(std::uint32_t slot) { referenced[slot] = 1; }
+
+    // TimeComplexity: O(1) - Amortized Cost
+    std::uint32_t evict() {
+        while( referenced[hand] ) {
+            referenced[hand] = 0;
+            advance();
+        }
+        std::uint32_t slot = hand;
+        advance();
+        return slot;
+    }
+private:
+    std::vector<unsigned char> referenced;
+    std::uint32_t hand;
+
+    void advance() { hand = ( hand + 1 == referenced.size() ) ? 0 : hand + 1; }
+};
+
+// Segmented LRU: new entries go to a probationary segment, and a hit
+//  promotes them to a protected segment of up to 80% of the capacity,
+//  whose least recently used entry is demoted back to probation when it
+//  overflows. Evictions come from probation first, so entries seen only
+//  once (a scan) cannot push out the ones seen twice.
+class SlruPolicy {
+public:
+    explicit SlruPolicy(std::uint32_t capacity)
+        : lists( capacity )
+        , isProtected( capacity, 0 )
+        , protectedCapacity( capacity / 5 * 4 )
+    {}
+
+    void inserted(std::uint32_t slot, int) {
+        isProtected[slot] = 0;
+        lists.pushFront( probation, slot );
+    }
+
+    void hit(std::uint32_t slot) {
+        if( isProtected[slot] ) {
+            lists.moveToFront( protectedSegment, slot );
+            return;
+        }
+        if( protectedCapacity == 0 ) {
+            lists.moveToFront( probation, slot );
+            return;
+        }
+        lists.unlink( probation, slot );
+        lists.pushFront( protectedSegment, slot );
+        isProtected[slot] = 1;
+        if( protectedSegment.size > protectedCapacity ) {
+            std::uint32_t demoted = protectedSegment.tail;
+            lists.unlink( protectedSegment, demoted );
+            lists.pushFront( probation, demoted );
+            isProtected[demoted] = 0;
+        }
+    }
+
+    std::uint32_t evict() {
+        SlotLists::List& from = probation.size != 0 ? probation : protectedSegment;
+        std::uint32_t slot = from.tail;
+        lists.unlink( from, slot );
+        return slot;
+    }
+private:
+    SlotLists lists;
+    SlotLists::List probation;
+    SlotLists::List protectedSegment;
+    std::vector<unsigned char> isProtected;
+    std::uint32_t protectedCapacity;
+};
+
+// S3-FIFO (Yang et al., SOSP'23): three FIFO queues and no reordering on
+//  a hit, which only bumps a 2 bit frequency.
+//  * small (10% of the capacity) takes new entries. Leaving it, an entry
+//    hit meanwhile moves to main, any other is evicted and its key
+//    remembered in ghost.
+//  * main holds the rest. Leaving it, an entry hit meanwhile goes back in
+//    with its frequency decremented, any other is evicted.
+//  * ghost remembers the keys of the last entries evicted from small, as
+//    many as main holds; a key coming back from it goes straight to main.
+//  Ghost is a table of eviction stamps indexed by a hash of the key, so a
+//  collision may send a new key to main: it costs nothing but precision.
+class S3FifoPolicy {
+public:
+    explicit S3FifoPolicy(std::uint32_t capacity)
+        : keys( capacity )
+        , frequency( capacity, 0 )
+        , small( capacity )
+        , main( capacity )
+        , smallCapacity( capacity / 10 > 0 ? capacity / 10 : 1 )
+        , ghostCapacity( capacity > smallCapacity ? capacity - smallCapacity : 1 )
+        , ghostStamp( 0 )
+    {
+        std::size_t buckets = 1;
+        while( buckets < ghostCapacity * 2 ) buckets <<= 1;
+        ghost.assign( buckets, 0 );
+    }
+
+    void inserted(std::uint32_t slot, int key) {
+        keys[slot] = key;
+        frequency[slot] = 0;
+        std::uint32_t& stamp = ghost[ ghostBucket( key ) ];
+        if( stamp != 0 && ghostStamp - stamp < ghostCapacity ) {
+            stamp = 0;
+            main.push( slot );
+        } else {
+            small.push( slot );
+        }
+    }
+
+    void hit(std::uint32_t slot) {
+        if( frequency[slot] < 3 ) ++frequency[slot];
+    }
+
+    // TimeComplexity: O(1) - Amortized Cost
+    std::uint32_t evict() {
+        for( ;; ) {
+            if( !small.empty() && ( small.size() >= smallCapacity || main.empty() ) ) {
+                std::uint32_t slot = small.pop();
+                if( frequency[slot] > 0 ) {
+                    frequency[slot] = 0;
+                    main.push( slot );
+                    continue;
+                }
+                ghost[ ghostBucket( keys[slot] ) ] = ++ghostStamp;
+                return slot;
+            }
+            std::uint32_t slot = main.pop();
+            if( frequency[slot] > 0 ) {
+                --frequency[slot];
+                main.push( slot );
+                continue;
+            }
+            return slot;
+        }
+    }
+private:
+    // FIFO of slots on a ring
+    class SlotQueue {
+    public:
+        explicit SlotQueue(std::uint32_t capacity) : slots( capacity > 0 ? capacity : 1 ) {}
+
+        void push(std::uint32_t slot) {
+            std::size_t back = first + count;
+            slots[ back < slots.size() ? back : back - slots.size() ] = slot;
+            ++count;
+        }
+
+        std::uint32_t pop() {
+            std::uint32_t slot = slots[first];
+            first = ( first + 1 == slots.size() ) ? 0 : first + 1;
+            --count;
+            return slot;
+        }
+
+        bool empty() const { return count == 0; }
+        std::size_t size() const { return count; }
+    private:
+        std::vector<std::uint32_t> slots;
+        std::size_t first = 0;
+        std::size_t count = 0;
+    };
+
+    std::vector<int> keys;
+    std::vector<unsigned char> frequency;
+    SlotQueue small;
+    SlotQueue main;
+    std::uint32_t smallCapacity;
+    std::uint32_t ghostCapacity;
+    std::vector<std::uint32_t> ghost;
+    std::uint32_t ghostStamp;
+
+    std::size_t ghostBucket(int key) const {
+        std::uint32_t h = static_cast<std::uint32_t>( key ) * 0x85EBCA6Bu;
+        h ^= h >> 15;
+        return h & ( ghost.size() - 1 );
+    }
+};
+
+using ClockCache = BasicCache<ClockPolicy>;
+using SlruCache = BasicCache<SlruPolicy>;
+using S3FifoCache = BasicCache<S3FifoPolicy>;
+
+#endif // EVICTION_POLICIES_H
@@ -1,193 +1,130 @@
 #include <iostream>
 #include <vector>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <string>
-#include <algorithm>
-#include <set>
+#include <random>
+#include <chrono>
+#include <cstdint>
 #include <cassert>
 #include <fstream>
-using namespace std;
-
-struct Node{
-   Node* next;
-   Node* prev;
-   int value;
-   int key;
-   Node(Node* p, Node* n, int k, int val):prev(p),next(n),key(k),value(val){};
-   Node(int k, int val):prev(NULL),next(NULL),key(k),value(val){};
-};
 
-class Cache{
-   
-   protected: 
-   map<int,Node*> mp; //map the key to the node in the linked list
-   int cp;  //capacity
-   Node* tail; // double linked list tail pointer
-   Node* head; // double linked list head pointer
-   virtual void set(int, int) = 0; //set function
-   virtual int get(int) = 0; //get function
+#include "LRUCache.h"
+using namespace std;
 
-};
-class LRUCache: public Cache {
+// The textbook LRU: std::list for recency, std::map from key to list node
+class ReferenceLRU {
 public:
-    LRUCache(int capacity) : Cache()
-    {
-        cp = capacity;
-        tail = nullptr;
-        head = nullptr;
-        cacheSize = 0;
-    }
-    
+    explicit ReferenceLRU(int capacity) : cp( capacity ) {}
+
     void set(int key, int value) {
-        /*
-        cout << "Setting (" << key << ", " << value << ") into [" ;
-        Node* t = head;
-        while( t != nullptr ) {
-            cout << "(" << t->key << ", " << t->value << ") ";
-            t = t->next;
+        if( cp <= 0 ) return;
+        auto iter = mp.find( key );
+        if( iter != mp.end() ) {
+            iter->second->second = value;
+            lru.splice( lru.begin(), lru, iter->second );
+            return;
         }
-        cout << "]" << endl;
-        */
-        Node* node = quickGet(key);
-        
-        if( node == nullptr ) { //Store Miss
-            node = new Node(key, value);
-            node = saveInStore(node);
-            saveInCache(node);
+        if( static_cast<int>( mp.size() ) == cp ) {
+            mp.erase( lru.back().first );
+            lru.pop_back();
         }
-        markAsMostRecentlyUsed(node);
+        lru.emplace_front( key, value );
+        mp[key] = lru.begin();
     }
-    
+
     int get(int key) {
-        /*
-        cout << "getting (" << key << ") from [" ;
-        Node* t = head;
-        while( t != nullptr ) {
-            cout << "(" << t->key << ", " << t->value << ") ";
-            t = t->next;
-        }
-        cout << "]" << endl;
-        */
-        Node* node = quickGet(key);
-        if( node == nullptr ) { //Store miss
-            return -1;
-        } else {
-            markAsMostRecentlyUsed(node);
-            return node->value;
-        }
+        auto iter = mp.find( key );
+        if( iter == mp.end() ) return -1;
+        lru.splice( lru.begin(), lru, iter->second );
+        return iter->second->second;
     }
 private:
-    int cacheSize;
-    
-    Node* quickGet(int key) {
-        auto iter = mp.find(key);
-        return ( iter == mp.end() ? nullptr : iter->second );
-    }
-    
-    //Knocks out least recently used, if ther is no room for node
-    // effectlively increasing size by one, if knock out doesnt happen
-    //  otherwise size remains unchanged
-    void saveInCache(Node* node) {
-        if( cacheSize == cp ) {
-            removeLeastRecentlyUsed();
-        }
-        
-        insertToHead(node);
-    }
-    
-    Node* saveInStore(Node* node) {
-        auto insResult = mp.emplace(node->key, node);
-        auto iter = insResult.first;
-        auto insertedNode = iter->second;
-        
-        if ( !insResult.second )  {
-            insertedNode->value = node->value;
-        }
-        
-        return insertedNode;
+    int cp;
+    list<pair<int, int>> lru;
+    map<int, list<pair<int, int>>::iterator> mp;
+};
+
+template<typename Cache>
+double opsPerSecond(Cache& cache, const vector<pair<int, int>>& ops, long& checksum) {
+    auto start = chrono::steady_clock::now();
+    for(auto& op: ops ) {
+        if( op.second < 0 ) checksum += cache.get( op.first );
+        else cache.set( op.first, op.second );
     }
-    
-    // Moves node from its current postion to head of the cache
-    // effectlively leaving size of cache unchanged
-    void markAsMostRecentlyUsed(Node* node) {
-        Node* prevNode = node->prev;
-        Node* nextNode = node->next;
-        
-        if( prevNode != nullptr && nextNode != nullptr ) { //Node in between head and tail
-            prevNode->next = nextNode;
-            nextNode->prev = prevNode;
-            
-            node->next = head;
-            head->prev = node;
-            node->prev = nullptr;
-        } else if(prevNode == nullptr ) { // node already at head
-            // Do Nothing
-        } else if ( nextNode == nullptr ) { //Node at tail
-            prevNode->next = nullptr;
-            
-            node->next = head;
-            head->prev = node;
-            node->prev = nullptr;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return ops.size() / elapsed.count();
+}
+
+// With an input file: runs the commands in it, printing what each get
+//  returns. Without: checks LRUCache against ReferenceLRU on random
+//  operations, then compares their speed.
+int main(int argc, char** argv) {
+    if( argc == 2 ) {
+        int n, capacity, i;
+        ifstream in(argv[1]);
+        in >> n >> capacity;
+        LRUCache l(capacity);
+        for(i=0;i<n;i++) {
+            string command;
+            in >> command;
+            if(command == "get") {
+                int key;
+                in >> key;
+                cout << l.get(key) << endl;
+            }
+            else if(command == "set") {
+                int key, value;
+                in >> key >> value;
+                l.set(key,value);
+            }
         }
-        
-        
+        return 0;
     }
-    
-    void insertToHead(Node* node) {
-        if( head == nullptr ) {
-            head = node;
-            tail = node;
-        } else {
-            node->next = head;
-            node->prev = nullptr;
-            head->prev = node;
-            head = node;
+
+    mt19937 gen( 11 );
+    for(int capacity: { 0, 1, 2, 3, 17, 1000 } ) {
+        LRUCache cache( capacity );
+        ReferenceLRU reference( capacity );
+        uniform_int_distribution<int> keys( -capacity * 2 - 2, capacity * 2 + 2 );
+        for(int i = 0; i < 200000; ++i ) {
+            int key = keys( gen );
+            if( gen() % 2 ) {
+                int value = static_cast<int>( gen() % 1000 );
+                cache.set( key, value );
+                reference.set( key, value );
+            } else if( cache.get( key ) != reference.get( key ) ) {
+                cout << "Test Case Failed at " << __LINE__ << endl;
+                return -1;
+            }
+            if( cache.size() > capacity ) {
+                cout << "Test Case Failed at " << __LINE__ << endl;
+                return -1;
+            }
         }
-        
-        cacheSize++;
     }
-    
-    void removeLeastRecentlyUsed() {
-        if( tail == nullptr ) return;
-        
-        Node* node = tail;
-        mp.erase(node->key);
-        removeTail();
+
+    // Reference data lookups: mostly gets over a key space larger than
+    //  the cache, with a set after each miss
+    const int capacity = 100000;
+    vector<pair<int, int>> ops;
+    uniform_int_distribution<int> hot( 0, capacity / 2 ), cold( 0, capacity * 4 );
+    for(int i = 0; i < 5000000; ++i ) {
+        int key = gen() % 4 ? hot( gen ) : cold( gen );
+        ops.emplace_back( key, -1 );
+        if( i % 5 == 0 ) ops.emplace_back( key, key );
     }
-    
-    void removeTail() {
-        Node* node = tail;
-        // std::cout << "Removing tail (" << node->key << ", " << node->value << ")" << endl;
-        tail = tail->prev;
-        tail->next = nullptr;
-        
-        // Make sure the node no longer points to anybody in our store/cache
-        node->next = nullptr;
-        node->prev = nullptr;
-        
-        cacheSize--;
+    long checksum = 0, referenceChecksum = 0;
+    LRUCache cache( capacity );
+    ReferenceLRU reference( capacity );
+    double fast = opsPerSecond( cache, ops, checksum );
+    double slow = opsPerSecond( reference, ops, referenceChecksum );
+    if( checksum != referenceChecksum ) {
+        cout << "Test Case Failed at " << __LINE__ << endl;
+        return -1;
     }
-};
-int main(int argc, char** argv) {
-   int n, capacity,i;
-    if( argc != 2 ) return -1;
-    ifstream in(argv[1]);
-   in >> n >> capacity;
-   LRUCache l(capacity);
-   for(i=0;i<n;i++) {
-      string command;
-      in >> command;
-      if(command == "get") {
-         int key;
-         in >> key;
-         cout << l.get(key) << endl;
-      } 
-      else if(command == "set") {
-         int key, value;
-         in >> key >> value;
-         l.set(key,value);
-      }
-   }
-   return 0;
+    cout << "LRUCache: " << static_cast<long long>( fast ) << " ops/s, std::map + std::list: "
+         << static_cast<long long>( slow ) << " ops/s" << endl;
+    return 0;
 }
-
@@ -0,0 +1,207 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Doubly linked lists of cache slots, threaded through 32 bit prev/next
+//  indices held in one array. Several lists can share the array, as long
+//  as a slot is on at most one of them.
+class SlotLists {
+public:
+    static const std::uint32_t Nil = 0xFFFFFFFFu;
+
+    struct List {
+        std::uint32_t head = Nil;   // front
+        std::uint32_t tail = Nil;   // back
+        std::uint32_t size = 0;
+    };
+
+    explicit SlotLists(std::size_t slots) : links( slots ) {}
+
+    void pushFront(List& list, std::uint32_t slot) {
+        Link& l = links[slot];
+        l.prev = Nil;
+        l.next = list.head;
+        if( list.head != Nil ) links[list.head].prev = slot; else list.tail = slot;
+        list.head = slot;
+        ++list.size;
+    }
+
+    void unlink(List& list, std::uint32_t slot) {
+        Link& l = links[slot];
+        if( l.prev != Nil ) links[l.prev].next = l.next; else list.head = l.next;
+        if( l.next != Nil ) links[l.next].prev = l.prev; else list.tail = l.prev;
+        --list.size;
+    }
+
+    void moveToFront(List& list, std::uint32_t slot) {
+        if( slot == list.head ) return;
+        unlink( list, slot );
+        pushFront( list, slot );
+    }
+private:
+    struct Link {
+        std::uint32_t prev;
+        std::uint32_t next;
+    };
+
+    std::vector<Link> links;
+};
+
+// Evicts the least recently used slot: every hit moves the slot to the
+//  front of the recency list
+class LRUPolicy {
+public:
+    explicit LRUPolicy(std::uint32_t capacity) : lists( capacity ) {}
+
+    void inserted(std::uint32_t slot, int) { lists.pushFront( recency, slot ); }
+
+    // Moves slot from its current position to the head of the list
+    void hit(std::uint32_t slot) { lists.moveToFront( recency, slot ); }
+
+    std::uint32_t evict() {
+        std::uint32_t slot = recency.tail;
+        lists.unlink( recency, slot );
+        return slot;
+    }
+private:
+    SlotLists lists;
+    SlotLists::List recency;
+};
+
+// BasicCache keeps up to 'capacity' key/value pairs, evicting an entry
+//  chosen by Policy to make room. All memory is allocated on
+//  construction:
+//  * entries: a fixed array of capacity slots
+//  * index: an open-addressing hash table (linear probing, at most half
+//    full) mapping a key to its slot. Buckets carry the key, so a probe
+//    does not touch the entries. Deletion shifts the following buckets
+//    back, so there are no tombstones.
+//  Once full, the slot of the evicted entry is reused for the insert
+//  which evicted it.
+//  Policy keeps whatever it needs per slot, and is told:
+//    Policy(std::uint32_t capacity)
+//    void inserted(std::uint32_t slot, int key)  slot now holds key
+//    void hit(std::uint32_t slot)                 slot was read or updated
+//    std::uint32_t evict()                        all slots are in use: pick
+//                                                 one, which is forgotten
+//  See EvictionPolicies.h for CLOCK, SLRU and S3-FIFO.
+template<typename Policy>
+class BasicCache {
+public:
+    explicit BasicCache(int capacity)
+        : entries( capacity > 0 ? capacity : 0 )
+        , policy( static_cast<std::uint32_t>( entries.size() ) )
+        , used( 0 )
+    {
+        std::size_t buckets = 2;
+        while( buckets < entries.size() * 2 ) buckets <<= 1;
+        index.assign( buckets, Bucket{ 0, Nil } );
+        mask = static_cast<std::uint32_t>( buckets - 1 );
+        shift = 32;
+        while( ( std::size_t(1) << ( 32 - shift ) ) < buckets ) --shift;
+    }
+
+    // TimeComplexity: O(1) - Expected Cost, for the policies here
+    void set(int key, int value) {
+        if( entries.empty() ) return;
+        std::uint32_t b = find( key );
+        if( index[b].slot != Nil ) {
+            std::uint32_t slot = index[b].slot;
+            entries[slot].value = value;
+            policy.hit( slot );
+            return;
+        }
+
+        std::uint32_t slot;
+        if( used < entries.size() ) {
+            slot = used++;
+        } else {
+            // Full: evict, and reuse the evicted entry's slot
+            slot = policy.evict();
+            erase( find( entries[slot].key ) );
+            b = find( key );
+        }
+        entries[slot].key = key;
+        entries[slot].value = value;
+        index[b] = Bucket{ key, slot };
+        policy.inserted( slot, key );
+    }
+
+    // Value of key, -1 if it is not cached
+    // TimeComplexity: O(1) - Expected Cost
+    int get(int key) {
+        if( entries.empty() ) return -1;
+        std::uint32_t slot = index[ find( key ) ].slot;
+        if( slot == Nil ) return -1;
+        policy.hit( slot );
+        return entries[slot].value;
+    }
+
+    // Value of key, -1 if it is not cached, without telling the policy
+    // TimeComplexity: O(1) - Expected Cost
+    int peek(int key) const {
+        if( entries.empty() ) return -1;
+        std::uint32_t slot = index[ find( key ) ].slot;
+        return slot == Nil ? -1 : entries[slot].value;
+    }
+
+    // Tells the policy of a hit on key, if it is cached
+    // TimeComplexity: O(1) - Expected Cost
+    void touch(int key) {
+        if( entries.empty() ) return;
+        std::uint32_t slot = index[ find( key ) ].slot;
+        if( slot != Nil ) policy.hit( slot );
+    }
+
+    int size() const { return static_cast<int>( used ); }
+    int capacity() const { return static_cast<int>( entries.size() ); }
+private:
+    static const std::uint32_t Nil = 0xFFFFFFFFu;
+
+    struct Entry {
+        int key;
+        int value;
+    };
+
+    struct Bucket {
+        int key;
+        std::uint32_t slot;  // Nil for an empty bucket
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Bucket> index;
+    Policy policy;
+    std::uint32_t mask;
+    unsigned shift;
+    std::uint32_t used;
+
+    std::uint32_t home(int key) const {
+        return static_cast<std::uint32_t>( ( static_cast<std::uint64_t>( static_cast<std::uint32_t>( key ) ) * 0x9E3779B97F4A7C15ull ) >> 32 ) >> shift;
+    }
+
+    // Bucket holding key, or the empty bucket where it would go
+    std::uint32_t find(int key) const {
+        std::uint32_t b = home( key );
+        while( index[b].slot != Nil && index[b].key != key ) b = ( b + 1 ) & mask;
+        return b;
+    }
+
+    // Backward shift deletion
+    void erase(std::uint32_t hole) {
+        for( std::uint32_t b = ( hole + 1 ) & mask; index[b].slot != Nil; b = ( b + 1 ) & mask ) {
+            // Move the bucket into the hole unless its home lies in (hole, b]
+            if( ( ( b - home( index[b].key ) ) & mask ) >= ( ( b - hole ) & mask ) ) {
+                index[hole] = index[b];
+                hole = b;
+            }
+        }
+        index[hole].slot = Nil;
+    }
+};
+
+using LRUCache = BasicCache<LRUPolicy>;
+
+#endif // LRU_CACHE_H